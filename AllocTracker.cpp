@@ -0,0 +1,173 @@
+#include "AllocTracker.h"
+#include <cstdlib>
+#include <new>
+
+// State operator new updates is per thread, so other threads (the metrics server) allocate without racing the game
+// thread; their counts are never reported, and they never run steady frames. The rest is touched by the game thread only
+static thread_local AllocCounts running[ALLOC_SUBSYSTEM_COUNT]; // Counts of the frame in progress
+static thread_local AllocSubsystem current = ALLOC_OTHER; // Subsystem being charged
+static thread_local int exemptDepth = 0; // Nesting depth of AllocExempt
+static thread_local bool steadyFrame = false; // Whether the current frame is steady-state gameplay
+static AllocCounts lastFrame[ALLOC_SUBSYSTEM_COUNT]; // Counts of the last completed frame
+static AllocCounts lastTotal; // Sum of lastFrame
+static bool strictMode = false; // Whether steady-state allocations are violations
+static bool violated = false; // Whether a violation happened
+static AllocSubsystem violationSubsystem = ALLOC_OTHER; // Where the first violation happened
+static size_t violationBytes = 0; // Size of the first violating allocation
+
+// Subsystem names, in enum order
+static const char* const SUBSYSTEM_NAMES[ALLOC_SUBSYSTEM_COUNT] = {
+    "other", "physics", "waves", "spawn", "ai", "zombies", "terrain", "food", "render"};
+
+// Records one allocation; must not allocate itself
+static void recordAllocation(size_t bytes) {
+    running[current].count++;
+    running[current].bytes += bytes;
+    if (steadyFrame && strictMode && exemptDepth == 0 && !violated) { // steadyFrame first: other threads stop there
+        violated = true;
+        violationSubsystem = current;
+        violationBytes = bytes;
+    }
+}
+
+#ifdef TRACK_ALLOCATIONS
+// Counting replacements for the global allocation functions
+
+void* operator new(size_t size) {
+    recordAllocation(size);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    recordAllocation(size);
+    size_t a = static_cast<size_t>(align);
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) return p; // aligned_alloc wants a multiple of the alignment
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size, std::align_val_t align) {
+    return operator new(size, align);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    recordAllocation(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+#endif
+
+// Whether the counting operator new is compiled in
+bool allocTrackingEnabled() {
+#ifdef TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Name of a subsystem
+const char* allocSubsystemName(AllocSubsystem subsystem) {
+    return SUBSYSTEM_NAMES[subsystem];
+}
+
+// Ends a frame
+void allocEndFrame() {
+    lastTotal = {0, 0};
+    for (int i = 0; i < ALLOC_SUBSYSTEM_COUNT; i++) {
+        lastFrame[i] = running[i];
+        lastTotal.count += running[i].count;
+        lastTotal.bytes += running[i].bytes;
+        running[i] = {0, 0};
+    }
+    steadyFrame = false;
+}
+
+// Total counts of the last completed frame
+const AllocCounts& allocFrameTotal() {
+    return lastTotal;
+}
+
+// Counts of one subsystem in the last completed frame
+const AllocCounts& allocFrameCounts(AllocSubsystem subsystem) {
+    return lastFrame[subsystem];
+}
+
+// Turns strict mode on or off
+void allocSetStrict(bool strict) {
+    strictMode = strict;
+}
+
+// Whether strict mode is on
+bool allocStrict() {
+    return strictMode;
+}
+
+// Marks the rest of the current frame as steady-state gameplay
+void allocSetSteady(bool steady) {
+    steadyFrame = steady;
+}
+
+// Whether a violation happened
+bool allocViolation() {
+    return violated;
+}
+
+// Describes the first violation
+void allocReportViolation(std::ostream& out) {
+    if (!violated) return;
+    out << "Heap allocation of " << violationBytes << " bytes in steady-state gameplay (subsystem "
+        << SUBSYSTEM_NAMES[violationSubsystem] << ")\n";
+}
+
+// Writes the CSV header
+void allocLogHeader(std::ostream& out) {
+    out << "frame,allocs,bytes";
+    for (const char* name : SUBSYSTEM_NAMES) out << "," << name;
+    out << "\n";
+}
+
+// Writes one CSV row with the last frame's counts (allocations per subsystem)
+void allocLogFrame(std::ostream& out, uint64_t frame) {
+    out << frame << "," << lastTotal.count << "," << lastTotal.bytes;
+    for (const auto& counts : lastFrame) out << "," << counts.count;
+    out << "\n";
+}
+
+// Charges allocations to a subsystem until destroyed
+AllocScope::AllocScope(AllocSubsystem subsystem) : previous(current) {
+    current = subsystem;
+}
+
+// Restores the previous subsystem
+AllocScope::~AllocScope() {
+    current = previous;
+}
+
+// Starts an exempt region
+AllocExempt::AllocExempt() {
+    exemptDepth++;
+}
+
+// Ends an exempt region
+AllocExempt::~AllocExempt() {
+    exemptDepth--;
+}
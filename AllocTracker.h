@@ -0,0 +1,82 @@
+#ifndef ALLOCTRACKER_H
+#define ALLOCTRACKER_H
+
+#include <cstdint>
+#include <ostream>
+
+// Heap allocation tracking. Building with -DTRACK_ALLOCATIONS (make tgame4-alloc) replaces the global operator new
+// and delete with counting versions; otherwise every count stays zero and the calls below cost nothing worth noting.
+// Only C++ allocations are seen: SDL and its satellites allocate with malloc directly. Counts are kept per thread and
+// only the game thread's are reported: call everything below from the thread that runs the frames
+
+// Subsystems allocations are charged to, set with AllocScope
+enum AllocSubsystem {
+    ALLOC_OTHER, // Anything outside a scope
+    ALLOC_PHYSICS, // Player and moving platforms
+    ALLOC_WAVES, // Wave scripts
+    ALLOC_SPAWN, // Zombie spawning
+    ALLOC_AI, // Spatial sort, senses, squads and behavior trees
+    ALLOC_ZOMBIES, // Zombie updates, hits and drops
+    ALLOC_TERRAIN, // Destruction follow-up: caches, jump tables, waking food
+    ALLOC_FOOD, // Food updates
+    ALLOC_RENDER, // Drawing
+    ALLOC_SUBSYSTEM_COUNT
+};
+
+// Allocation count and bytes requested
+struct AllocCounts {
+    uint64_t count; // Number of allocations
+    uint64_t bytes; // Bytes requested
+};
+
+// Whether the counting operator new is compiled in
+bool allocTrackingEnabled();
+
+// Name of a subsystem for logs and the overlay
+const char* allocSubsystemName(AllocSubsystem subsystem);
+
+// Ends a frame: its counts become the "last frame" counts, the running counts restart and steady state is cleared
+void allocEndFrame();
+
+// Counts of the last completed frame, in total and per subsystem
+const AllocCounts& allocFrameTotal();
+const AllocCounts& allocFrameCounts(AllocSubsystem subsystem);
+
+// Strict mode: any allocation while the current frame is marked steady (and not exempt) is a violation
+void allocSetStrict(bool strict);
+bool allocStrict();
+
+// Marks the rest of the current frame as steady-state gameplay
+void allocSetSteady(bool steady);
+
+// Whether a violation happened, and where the first one was
+bool allocViolation();
+void allocReportViolation(std::ostream& out);
+
+// Writes a CSV header, or one CSV row with the last frame's counts
+void allocLogHeader(std::ostream& out);
+void allocLogFrame(std::ostream& out, uint64_t frame);
+
+// Charges allocations made during its lifetime to a subsystem
+class AllocScope {
+public:
+    explicit AllocScope(AllocSubsystem subsystem);
+    ~AllocScope();
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    AllocSubsystem previous; // Subsystem to restore
+};
+
+// Allows allocations during its lifetime even in steady state, for rare events such as a wave starting.
+// They are still counted
+class AllocExempt {
+public:
+    AllocExempt();
+    ~AllocExempt();
+    AllocExempt(const AllocExempt&) = delete;
+    AllocExempt& operator=(const AllocExempt&) = delete;
+};
+
+#endif
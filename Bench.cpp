@@ -0,0 +1,111 @@
+#include "Bench.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+// Sets the repeat count and duration
+BenchSuite::BenchSuite(int repeats, double minRepeatSeconds) : repeats(std::max(1, repeats)), minRepeatSeconds(minRepeatSeconds) {}
+
+// Turns the per-repeat times into a result
+void BenchSuite::record(const char* name, std::vector<double>& nsPerOp, uint64_t ops) {
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    size_t n = nsPerOp.size();
+    double median = n % 2 ? nsPerOp[n / 2] : (nsPerOp[n / 2 - 1] + nsPerOp[n / 2]) / 2.0;
+    double mean = 0.0;
+    for (double v : nsPerOp) mean += v;
+    mean /= n;
+    double variance = 0.0;
+    for (double v : nsPerOp) variance += (v - mean) * (v - mean);
+    double stddev = n > 1 ? std::sqrt(variance / (n - 1)) : 0.0;
+    results.push_back({name, median, nsPerOp.front(), nsPerOp.back(), stddev, ops, static_cast<int>(n)});
+}
+
+// Records a skipped benchmark
+void BenchSuite::skip(const char* name, const char* reason) {
+    skipped.push_back(std::string(name) + ": skipped, " + reason);
+}
+
+// Writes the results as a table
+void BenchSuite::print(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::left << std::setw(28) << "benchmark" << std::right << std::setw(12) << "ns/op" << std::setw(12) << "min"
+        << std::setw(12) << "max" << std::setw(9) << "+/-%" << std::setw(12) << "ops" << "\n";
+    out << std::fixed;
+    for (const BenchResult& r : results) {
+        double spread = r.medianNs > 0.0 ? 100.0 * r.stddevNs / r.medianNs : 0.0;
+        out << std::left << std::setw(28) << r.name << std::right << std::setprecision(2) << std::setw(12) << r.medianNs
+            << std::setw(12) << r.minNs << std::setw(12) << r.maxNs << std::setprecision(1) << std::setw(9) << spread
+            << std::setw(12) << r.opsPerRepeat << "\n";
+    }
+    for (const std::string& line : skipped) out << line << "\n";
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// Writes the medians as a baseline
+bool BenchSuite::save(const char* path) const {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Benchmarks: cannot write " << path << "\n";
+        return false;
+    }
+    out << "# Micro-benchmark baseline: name and median ns/op (make bench-baseline rewrites this file)\n";
+    out << std::setprecision(6);
+    for (const BenchResult& r : results) out << r.name << " " << r.medianNs << "\n";
+    std::cout << "Benchmarks: " << results.size() << " medians written to " << path << "\n";
+    return static_cast<bool>(out);
+}
+
+// Compares the medians with a baseline
+int BenchSuite::compare(const char* path, double threshold, bool allowNew, std::ostream& out) const {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        std::cerr << "Benchmarks: cannot read baseline " << path << "\n";
+        return -1;
+    }
+    std::map<std::string, double> baseline;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string name;
+        double ns = 0.0;
+        if (fields >> name >> ns && ns > 0.0) baseline[name] = ns;
+    }
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(1);
+    int regressions = 0, unmatched = 0;
+    std::map<std::string, double> unseen = baseline; // Baseline entries without a result, once the loop is done
+    for (const BenchResult& r : results) {
+        auto found = baseline.find(r.name);
+        out << std::left << std::setw(28) << r.name << std::right;
+        if (found == baseline.end()) {
+            if (!allowNew) unmatched++;
+            out << (allowNew ? "  no baseline (allowed)\n" : "  NO BASELINE\n");
+            continue;
+        }
+        unseen.erase(r.name);
+        double change = r.medianNs / found->second - 1.0;
+        bool regressed = change > threshold;
+        if (regressed) regressions++;
+        out << std::setw(12) << found->second << " -> " << std::setw(10) << r.medianNs << " ns/op  "
+            << std::showpos << std::setw(7) << 100.0 * change << std::noshowpos << "%" << (regressed ? "  REGRESSION" : "") << "\n";
+    }
+    for (const auto& entry : unseen) { // A skipped or removed benchmark must not pass unnoticed
+        out << std::left << std::setw(28) << entry.first << std::right << std::setw(12) << entry.second << " -> "
+            << std::setw(10) << "-" << " ns/op  NOT RUN\n";
+        unmatched++;
+    }
+    out << regressions << " of " << results.size() << " benchmarks more than " << 100.0 * threshold << "% slower than " << path;
+    if (unmatched > 0) out << "; " << unmatched << " without a result or a baseline entry";
+    out << "\n";
+    out.flags(flags);
+    out.precision(precision);
+    return regressions + unmatched;
+}
@@ -0,0 +1,100 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Micro-benchmark harness (tgame4 --micro-bench). Each benchmark is a function that performs n operations; the
+// harness doubles n until one repeat takes long enough to time reliably (which also warms caches and branch
+// predictors), then times a fixed number of repeats and reports the median ns/op with the spread. Results can be
+// saved as a baseline and later compared against it, failing when a benchmark got slower than a threshold
+
+// Keeps a value alive so the compiler cannot drop the work that produced it
+template <typename T>
+inline void benchKeep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Timing of one benchmark
+struct BenchResult {
+    std::string name; // Benchmark name (no spaces: it is the key in baseline files)
+    double medianNs; // Median ns/op over the repeats; what baselines store and compare
+    double minNs; // Fastest repeat
+    double maxNs; // Slowest repeat
+    double stddevNs; // Standard deviation over the repeats
+    uint64_t opsPerRepeat; // Operations timed per repeat
+    int repeats; // Repeats timed
+};
+
+class BenchSuite {
+public:
+    // repeats: timed repeats per benchmark; minRepeatSeconds: target duration of one repeat
+    explicit BenchSuite(int repeats = 15, double minRepeatSeconds = 0.02);
+
+    // Times body(n), which must perform n operations, and records the result
+    template <typename Body>
+    void run(const char* name, Body&& body);
+
+    // As run(name, body), but calls setup() untimed before every body(n), so each repeat starts from the same state
+    template <typename Setup, typename Body>
+    void run(const char* name, Setup&& setup, Body&& body);
+
+    // Records a benchmark that could not run (missing assets, no renderer); it is reported, and fails a comparison
+    // against a baseline that has it
+    void skip(const char* name, const char* reason);
+
+    // Writes the results as a table
+    void print(std::ostream& out) const;
+
+    // Writes the medians as a baseline file. Returns false (and logs) if the file cannot be written
+    bool save(const char* path) const;
+
+    // Compares the medians with a baseline and writes the differences. Returns the number of failures, or -1 if the
+    // baseline cannot be read. A failure is a benchmark more than threshold (0.15 = 15%) slower than its baseline, a
+    // baseline entry without a result (skipped or gone), or a result without a baseline entry unless allowNew
+    int compare(const char* path, double threshold, bool allowNew, std::ostream& out) const;
+
+private:
+    // Turns the per-repeat times into a result
+    void record(const char* name, std::vector<double>& nsPerOp, uint64_t ops);
+
+    int repeats; // Timed repeats per benchmark
+    double minRepeatSeconds; // Target duration of one repeat
+    std::vector<BenchResult> results; // Benchmarks run, in order
+    std::vector<std::string> skipped; // Benchmarks skipped, with their reasons
+};
+
+// Times body(n)
+template <typename Body>
+void BenchSuite::run(const char* name, Body&& body) {
+    run(name, []() {}, body);
+}
+
+// Times body(n), resetting with setup() before each call
+template <typename Setup, typename Body>
+void BenchSuite::run(const char* name, Setup&& setup, Body&& body) {
+    using Clock = std::chrono::steady_clock;
+    uint64_t ops = 1;
+    for (;;) { // Calibrate: double n until one repeat is long enough
+        setup();
+        auto start = Clock::now();
+        body(ops);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= minRepeatSeconds || ops >= (uint64_t(1) << 40)) break;
+        ops *= 2;
+    }
+    std::vector<double> nsPerOp;
+    nsPerOp.reserve(repeats);
+    for (int r = 0; r < repeats; r++) {
+        setup();
+        auto start = Clock::now();
+        body(ops);
+        nsPerOp.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / ops);
+    }
+    record(name, nsPerOp, ops);
+}
+
+#endif
@@ -0,0 +1,76 @@
+#include "FrameArena.h"
+#include <charconv>
+#include <cstdint>
+#include <new>
+
+// Constructor with the initial buffer size in bytes
+FrameArena::FrameArena(size_t capacity_)
+    : buffer(static_cast<char*>(::operator new(capacity_))), capacity(capacity_), offset(0),
+      extra(nullptr), extraBytes(0), highWater(0) {}
+
+// Frees the buffer and any extra blocks
+FrameArena::~FrameArena() {
+    reset();
+    ::operator delete(buffer);
+}
+
+// Bumps the offset, or falls back to an extra block when the buffer is full. The address is aligned, not the offset:
+// the buffer itself is only aligned for new, which is less than some requests ask for
+void* FrameArena::do_allocate(size_t bytes, size_t alignment) {
+    uintptr_t base = reinterpret_cast<uintptr_t>(buffer);
+    size_t start = ((base + offset + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1)) - base;
+    if (start + bytes <= capacity) {
+        offset = start + bytes;
+        return buffer + start;
+    }
+    // Extra block: header, padding up to the alignment, then the data
+    if (alignment < alignof(Block)) alignment = alignof(Block);
+    size_t header = (sizeof(Block) + alignment - 1) & ~(alignment - 1);
+    char* raw = static_cast<char*>(::operator new(header + bytes, std::align_val_t(alignment)));
+    Block* block = reinterpret_cast<Block*>(raw);
+    block->next = extra;
+    block->alignment = alignment;
+    extra = block;
+    extraBytes += bytes;
+    return raw + header;
+}
+
+// Releases everything allocated this frame and grows the buffer if the frame overflowed it
+void FrameArena::reset() {
+    size_t used = offset + extraBytes;
+    if (used > highWater) highWater = used;
+    while (extra) {
+        Block* next = extra->next;
+        ::operator delete(extra, std::align_val_t(extra->alignment));
+        extra = next;
+    }
+    if (extraBytes > 0) { // Next time the whole frame fits in one buffer
+        ::operator delete(buffer);
+        capacity = highWater + highWater / 2;
+        buffer = static_cast<char*>(::operator new(capacity));
+    }
+    offset = 0;
+    extraBytes = 0;
+}
+
+// Bytes handed out this frame
+size_t FrameArena::getUsed() const {
+    return offset + extraBytes;
+}
+
+// Size of the main buffer
+size_t FrameArena::getCapacity() const {
+    return capacity;
+}
+
+// Most bytes used in one frame
+size_t FrameArena::getHighWater() const {
+    return highWater;
+}
+
+// Appends a decimal integer without building a temporary std::string
+void appendNumber(FrameString& text, long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    text.append(digits, result.ptr);
+}
@@ -0,0 +1,63 @@
+#ifndef FRAMEARENA_H
+#define FRAMEARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// Bump allocator for data that lives for one frame. Allocating moves a pointer and freeing does nothing;
+// reset() at the end of the frame releases everything at once. Requests that do not fit go to extra heap blocks,
+// and the next reset() grows the buffer to the frame's high-water mark, so steady frames make no heap calls
+class FrameArena : public std::pmr::memory_resource {
+public:
+    // Constructor with the initial buffer size in bytes
+    explicit FrameArena(size_t capacity);
+
+    // Frees the buffer and any extra blocks
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // Releases everything allocated this frame; containers using the arena must be gone by now
+    void reset();
+
+    // Bytes handed out this frame, buffer size, and most bytes any frame has needed
+    size_t getUsed() const;
+    size_t getCapacity() const;
+    size_t getHighWater() const;
+
+private:
+    // Bumps the offset, or falls back to an extra block when the buffer is full
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    // Nothing to do: memory comes back in bulk on reset()
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    // Only the same arena can free its own memory
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    // Header at the start of an extra block
+    struct Block {
+        Block* next; // Next extra block
+        size_t alignment; // Alignment it was allocated with (needed to free it)
+    };
+
+    char* buffer; // Main buffer
+    size_t capacity; // Size of the main buffer
+    size_t offset; // Bytes used in the main buffer
+    Block* extra; // Extra blocks allocated this frame
+    size_t extraBytes; // Bytes handed out from extra blocks this frame
+    size_t highWater; // Most bytes used in one frame
+};
+
+// Containers for per-frame scratch data: construct them with a FrameArena* and let them die before reset()
+template <typename T>
+using FrameVector = std::pmr::vector<T>;
+using FrameString = std::pmr::string;
+
+// Appends a decimal integer to a frame string without building a temporary std::string
+void appendNumber(FrameString& text, long long value);
+
+#endif
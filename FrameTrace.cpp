@@ -0,0 +1,174 @@
+#include "FrameTrace.h"
+#include "AllocTracker.h"
+#include "PerfCounters.h"
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static const size_t TRACE_FRAMES = 300; // Frames kept in the ring (5 seconds at 60 FPS)
+static const size_t TRACE_EVENTS = 4096; // Events kept in the ring
+static const uint64_t POST_SPIKE_FRAMES = 60; // Frames recorded after a spike before the window is written
+
+// One recorded frame
+struct TraceFrame {
+    uint64_t number; // Frame number since traceStart
+    double start; // Seconds since traceStart
+    double seconds; // Frame time (sum of the phase times)
+    float phaseMs[PERF_PHASE_COUNT]; // Time per phase in milliseconds
+    TraceCounts counts; // Entity counts at the end of the frame
+};
+
+// One recorded event
+struct TraceMark {
+    uint64_t frame; // Frame it happened in
+    double time; // Seconds since traceStart
+    const char* name; // Event name (a string literal)
+    long long value; // Event detail (count, wave number, ...)
+};
+
+// Trace state; frames and events are recorded from the game loop only, never from the metrics server thread
+static double budgetMs = 0.0; // Frame time budget; 0 when tracing is off
+static int maxDumps = 0; // Spike files one game may write
+static bool recording = false; // Whether a game is being recorded
+static std::vector<TraceFrame> frameRing; // Last TRACE_FRAMES frames
+static std::vector<TraceMark> eventRing; // Last TRACE_EVENTS events
+static uint64_t framesRecorded = 0; // Frames since traceStart; the next one goes to framesRecorded % TRACE_FRAMES
+static uint64_t eventsRecorded = 0; // Events since traceStart
+static std::chrono::steady_clock::time_point origin; // Time of traceStart
+static bool spikePending = false; // Whether a window is being completed
+static uint64_t spikeFrame = 0; // Frame that went over budget
+static double spikeMs = 0.0; // Its frame time
+static int dumpsWritten = 0; // Spike files written this game
+
+// Seconds since traceStart
+static double sinceStart() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count();
+}
+
+// Writes a JSON string (names are literals, but a stray quote must not break the file)
+static void writeString(std::ostream& out, const char* text) {
+    out << '"';
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') out << '\\';
+        out << *c;
+    }
+    out << '"';
+}
+
+// Writes every frame and event in the rings to spike_<frame>.json
+static void writeWindow() {
+    AllocExempt exempt; // Rare, and the file is the point
+    std::string path = "spike_" + std::to_string(spikeFrame) + ".json";
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Frame trace: cannot write " << path << "\n";
+        return;
+    }
+    out << std::fixed << std::setprecision(1); // Microseconds; the default precision turns long games into 1e+09
+    uint64_t first = framesRecorded > TRACE_FRAMES ? framesRecorded - TRACE_FRAMES : 0;
+    out << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"spikeFrame\":" << spikeFrame << ",\"spikeMs\":" << spikeMs
+        << ",\"budgetMs\":" << budgetMs << "},\"traceEvents\":[\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"game loop\"}}";
+    for (uint64_t n = first; n < framesRecorded; n++) {
+        const TraceFrame& frame = frameRing[n % TRACE_FRAMES];
+        double ts = frame.start * 1e6; // Microseconds
+        const TraceCounts& c = frame.counts;
+        out << ",\n{\"name\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << ts << ",\"dur\":" << frame.seconds * 1e6
+            << ",\"args\":{\"frame\":" << frame.number << ",\"overBudget\":" << (frame.seconds * 1000.0 > budgetMs ? "true" : "false")
+            << ",\"zombies\":" << c.zombies << ",\"food\":" << c.food << ",\"wave\":" << c.wave
+            << ",\"pendingSpawns\":" << c.pendingSpawns << "}}";
+        // Phases are laid end to end in enum order, which follows the loop; "other" (events, input, waves) comes first
+        for (int p = 0; p < PERF_PHASE_COUNT; p++) {
+            if (frame.phaseMs[p] <= 0.0f) continue;
+            out << ",\n{\"name\":";
+            writeString(out, perfPhaseName(static_cast<PerfPhase>(p)));
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":" << ts << ",\"dur\":" << frame.phaseMs[p] * 1000.0 << "}";
+            ts += frame.phaseMs[p] * 1000.0;
+        }
+        out << ",\n{\"name\":\"entities\",\"ph\":\"C\",\"pid\":1,\"ts\":" << frame.start * 1e6
+            << ",\"args\":{\"zombies\":" << c.zombies << ",\"food\":" << c.food << "}}";
+    }
+    uint64_t firstEvent = eventsRecorded > TRACE_EVENTS ? eventsRecorded - TRACE_EVENTS : 0;
+    for (uint64_t n = firstEvent; n < eventsRecorded; n++) {
+        const TraceMark& mark = eventRing[n % TRACE_EVENTS];
+        if (mark.frame < first) continue;
+        out << ",\n{\"name\":";
+        writeString(out, mark.name);
+        out << ",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":1,\"ts\":" << mark.time * 1e6 << ",\"args\":{\"frame\":" << mark.frame
+            << ",\"value\":" << mark.value << "}}";
+    }
+    out << "\n]}\n";
+    dumpsWritten++;
+    std::cout << "Frame spike: " << spikeMs << " ms at frame " << spikeFrame << " (budget " << budgetMs << " ms), "
+              << framesRecorded - first << " frames written to " << path << "\n";
+}
+
+// Sets the budget and the file limit
+void traceConfigure(double budget, int dumps) {
+    budgetMs = budget > 0.0 ? budget : 0.0;
+    maxDumps = dumps;
+}
+
+// Budget set by traceConfigure
+double traceBudgetMs() {
+    return budgetMs;
+}
+
+// Starts recording a game
+void traceStart() {
+    if (budgetMs <= 0.0) return;
+    frameRing.assign(TRACE_FRAMES, TraceFrame{});
+    eventRing.assign(TRACE_EVENTS, TraceMark{});
+    framesRecorded = 0;
+    eventsRecorded = 0;
+    spikePending = false;
+    dumpsWritten = 0;
+    origin = std::chrono::steady_clock::now();
+    perfTimePhases(true);
+    recording = true;
+}
+
+// Records an event in the current frame
+void traceEvent(const char* name, long long value) {
+    if (!recording) return;
+    eventRing[eventsRecorded++ % TRACE_EVENTS] = {framesRecorded, sinceStart(), name, value};
+}
+
+// Records the frame that just ended
+void traceEndFrame(const TraceCounts& counts) {
+    if (!recording) return;
+    TraceFrame& frame = frameRing[framesRecorded % TRACE_FRAMES];
+    frame.number = framesRecorded;
+    frame.seconds = 0.0;
+    for (int p = 0; p < PERF_PHASE_COUNT; p++) {
+        double seconds = perfLastFrameSeconds(static_cast<PerfPhase>(p));
+        frame.phaseMs[p] = static_cast<float>(seconds * 1000.0);
+        frame.seconds += seconds;
+    }
+    frame.start = sinceStart() - frame.seconds;
+    frame.counts = counts;
+    framesRecorded++;
+
+    double ms = frame.seconds * 1000.0;
+    if (!spikePending && ms > budgetMs && dumpsWritten < maxDumps && frame.number > 0) { // The first frame includes loading
+        spikePending = true;
+        spikeFrame = frame.number;
+        spikeMs = ms;
+    } else if (spikePending && frame.number >= spikeFrame + POST_SPIKE_FRAMES) {
+        writeWindow();
+        spikePending = false;
+    }
+}
+
+// Writes a pending window and stops recording
+void traceStop() {
+    if (!recording) return;
+    if (spikePending) writeWindow();
+    spikePending = false;
+    recording = false;
+    perfTimePhases(false);
+}
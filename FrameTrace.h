@@ -0,0 +1,40 @@
+#ifndef FRAMETRACE_H
+#define FRAMETRACE_H
+
+#include <cstddef>
+
+// Spike-triggered frame trace. Every frame is recorded into a ring (frame time, phase times from PerfCounters,
+// entity counts) along with the game events of that frame. When a frame takes longer than the budget, the trace
+// keeps recording for a few more frames and then writes the whole window, before and after the spike, to
+// spike_<frame>.json in the Chrome trace format (open it in chrome://tracing or ui.perfetto.dev).
+// Recording copies a few numbers per frame into memory reserved by traceStart, so it can stay on in production;
+// at most maxDumps files are written per game
+
+// Entity counts recorded with each frame
+struct TraceCounts {
+    int zombies; // Live zombies
+    int food; // Food items on the ground
+    int wave; // Current wave
+    int pendingSpawns; // Zombies queued by the wave director
+};
+
+// Sets the frame time budget in milliseconds (0 turns tracing off) and how many spike files one game may write
+void traceConfigure(double budgetMs, int maxDumps);
+
+// Budget set by traceConfigure (0 when tracing is off)
+double traceBudgetMs();
+
+// Starts recording a game: reserves the rings and turns on phase timing. Does nothing when tracing is off
+void traceStart();
+
+// Records an event in the current frame. name must outlive the game (a string literal): it is kept by pointer
+void traceEvent(const char* name, long long value = 0);
+
+// Records the frame that just ended (call after perfEndFrame: the frame time is the sum of its phase times)
+// and writes the trace once the window after a spike is complete
+void traceEndFrame(const TraceCounts& counts);
+
+// Writes a pending spike window early (at the end of a game) and stops recording
+void traceStop();
+
+#endif
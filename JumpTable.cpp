@@ -0,0 +1,112 @@
+#include "JumpTable.h"
+#include "Terrain.h"
+#include <algorithm>
+#include <cmath>
+
+// Longest arc followed before giving up on a landing
+static const int MAX_JUMP_TICKS = 240;
+
+// Constructor (empty table: every lookup reports no landing)
+JumpTable::JumpTable()
+    : gravity(0.0f), cols(0), rows(0), tileSize(1), reachLeft(0), reachRight(0), reachUp(0), reachDown(0) {}
+
+// Simulates every arc from every standing cell of the terrain
+void JumpTable::build(const Terrain& terrain, std::span<const float> speedClasses, std::span<const float> forceClasses, float gravity_) {
+    speeds.assign(speedClasses.begin(), speedClasses.end());
+    forces.assign(forceClasses.begin(), forceClasses.end());
+    gravity = gravity_;
+    cols = terrain.getCols();
+    rows = terrain.getRows();
+    tileSize = terrain.getTileSize();
+    reachLeft = reachRight = reachUp = reachDown = 0;
+    landings.assign(static_cast<size_t>(cols) * rows * speeds.size() * forces.size() * 2, -1);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) fillCell(terrain, c, r);
+    }
+}
+
+// Recomputes the take-off cells whose arcs can pass through a damaged pixel region. An arc from (c, r) stays within
+// the recorded reach of it, so only take-offs within that reach of the damage can have changed
+void JumpTable::update(const Terrain& terrain, const SDL_Rect& damaged) {
+    if (landings.empty()) return;
+    int c0 = damaged.x / tileSize - reachRight, c1 = (damaged.x + damaged.w - 1) / tileSize + reachLeft;
+    int r0 = damaged.y / tileSize - reachDown - 1, r1 = (damaged.y + damaged.h - 1) / tileSize + reachUp; // The row above can stand now
+    for (int r = std::max(0, r0); r <= std::min(rows - 1, r1); r++) {
+        for (int c = std::max(0, c0); c <= std::min(cols - 1, c1); c++) fillCell(terrain, c, r);
+    }
+}
+
+// Nearest class to a value in a class list, or -1 when it is empty
+static int nearestClass(const std::vector<float>& classes, float value) {
+    int best = -1;
+    for (size_t i = 0; i < classes.size(); i++) {
+        if (best < 0 || std::fabs(classes[i] - value) < std::fabs(classes[best] - value)) best = static_cast<int>(i);
+    }
+    return best;
+}
+
+// Nearest speed class
+int JumpTable::speedClass(float speed) const {
+    return nearestClass(speeds, speed);
+}
+
+// Nearest force class
+int JumpTable::forceClass(float force) const {
+    return nearestClass(forces, force);
+}
+
+// Fills every arc of one cell
+void JumpTable::fillCell(const Terrain& terrain, int c, int r) {
+    bool standing = !terrain.solidTile(c, r) && terrain.solidTile(c, r + 1);
+    size_t cell = static_cast<size_t>(r) * cols + c;
+    int32_t* out = &landings[cell * speeds.size() * forces.size() * 2];
+    for (size_t s = 0; s < speeds.size(); s++) {
+        for (size_t f = 0; f < forces.size(); f++) {
+            for (int dir = 0; dir < 2; dir++) {
+                float vx = dir ? speeds[s] : -speeds[s];
+                *out++ = standing ? simulate(terrain, c, r, vx, forces[f]) : -1;
+            }
+        }
+    }
+}
+
+// Follows one arc tick by tick from a standing cell
+int JumpTable::simulate(const Terrain& terrain, int c, int r, float vx, float vy) {
+    float x = (c + 0.5f) * tileSize; // Feet center
+    float y = static_cast<float>((r + 1) * tileSize); // Feet on top of the tile below
+    float maxX = static_cast<float>(cols * tileSize), maxY = static_cast<float>(rows * tileSize);
+    auto solidAt = [&](float px, float py) {
+        return terrain.solidTile(static_cast<int>(std::floor(px / tileSize)), static_cast<int>(std::floor(py / tileSize)));
+    };
+    int landed = -1;
+    int minC = c, maxC = c, minR = r, maxR = r;
+    for (int tick = 0; tick < MAX_JUMP_TICKS; tick++) {
+        vy += gravity; // Same order as the zombie update: gravity first, then move
+        float nx = x + vx, ny = y + vy;
+        if (nx < 0.0f || nx >= maxX || ny >= maxY) break; // Left the map
+        if (vx != 0.0f && solidAt(nx, y - 1.0f)) { // Wall at foot height stops the sideways motion
+            nx = x;
+            vx = 0.0f;
+        }
+        if (vy < 0.0f && solidAt(nx, ny - tileSize)) { // Head hits a ceiling
+            ny = y;
+            vy = 0.0f;
+        }
+        if (vy > 0.0f && solidAt(nx, ny)) { // Feet enter a tile on the way down: landed on top of it
+            landed = static_cast<int>(std::floor(ny / tileSize)) - 1;
+            x = nx;
+            break;
+        }
+        x = nx;
+        y = ny;
+        int cc = static_cast<int>(std::floor(x / tileSize)), cr = static_cast<int>(std::floor((y - 1.0f) / tileSize));
+        minC = std::min(minC, cc); maxC = std::max(maxC, cc);
+        minR = std::min(minR, cr - 1); maxR = std::max(maxR, cr); // The head tile counts too
+    }
+    reachLeft = std::max(reachLeft, c - minC + 1);
+    reachRight = std::max(reachRight, maxC - c + 1);
+    reachUp = std::max(reachUp, r - minR + 1);
+    reachDown = std::max(reachDown, maxR - r + 1);
+    if (landed < 0) return -1;
+    return landed * cols + static_cast<int>(std::floor(x / tileSize));
+}
@@ -0,0 +1,66 @@
+#ifndef JUMPTABLE_H
+#define JUMPTABLE_H
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class Terrain;
+
+// Where jumps land, precomputed for every standing cell (an empty tile with a solid tile below) and every
+// combination of horizontal speed class, jump force class and direction. Built at level load by simulating the
+// arcs with the game's gravity against the static tiles; patched around destroyed tiles. An AI jump check is then
+// one lookup instead of a simulated arc per zombie
+class JumpTable {
+public:
+    // Constructor (empty table: every lookup reports no landing)
+    JumpTable();
+
+    // Simulates every arc from every standing cell of the terrain
+    void build(const Terrain& terrain, std::span<const float> speedClasses, std::span<const float> forceClasses, float gravity);
+
+    // Recomputes the take-off cells whose arcs can pass through a damaged pixel region
+    void update(const Terrain& terrain, const SDL_Rect& damaged);
+
+    // Nearest speed / force class to a value (-1 when the table has none)
+    int speedClass(float speed) const;
+    int forceClass(float force) const;
+
+    // Standing cell a jump from standing cell (c, r) lands in, as row * cols + col; -1 if it leaves the map,
+    // never lands, or (c, r) is not a standing cell. dir is -1 for left, 1 for right
+    int landing(int c, int r, int speed, int force, int dir) const {
+        if (c < 0 || r < 0 || c >= cols || r >= rows || speed < 0 || force < 0) return -1;
+        size_t cell = static_cast<size_t>(r) * cols + c;
+        return landings[((cell * speeds.size() + speed) * forces.size() + force) * 2 + (dir > 0)];
+    }
+
+    // Row of the landing cell, or -1
+    int landingRow(int c, int r, int speed, int force, int dir) const {
+        int cell = landing(c, r, speed, force, dir);
+        return cell < 0 ? -1 : cell / cols;
+    }
+
+    // Heap bytes held by the landing table
+    size_t memoryBytes() const {
+        return landings.capacity() * sizeof(int32_t) + (speeds.capacity() + forces.capacity()) * sizeof(float);
+    }
+
+private:
+    // Fills every arc of one cell (all -1 unless it is a standing cell)
+    void fillCell(const Terrain& terrain, int c, int r);
+
+    // Follows one arc tick by tick from a standing cell: the feet center moves with the velocity, gravity is added
+    // each tick, walls stop horizontal motion and ceilings (one tile above the feet) stop the rise.
+    // Returns the landing cell or -1, and widens the recorded arc extents
+    int simulate(const Terrain& terrain, int c, int r, float vx, float vy);
+
+    std::vector<float> speeds; // Horizontal speed of each class (pixels per tick)
+    std::vector<float> forces; // Initial vertical velocity of each class (negative is up)
+    float gravity; // Added to the vertical velocity each tick
+    int cols, rows, tileSize; // Grid the table was built for
+    int reachLeft, reachRight, reachUp, reachDown; // Furthest any arc strayed from its take-off cell (tiles)
+    std::vector<int32_t> landings; // Per cell, speed class, force class and direction: landing cell or -1
+};
+
+#endif
@@ -0,0 +1,161 @@
+#include "Level.h"
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Default constructor (no level loaded)
+Level::Level() : mapping(nullptr), mappingSize(0), header(nullptr), solid(nullptr) {}
+
+// Unmaps the file
+Level::~Level() {
+    if (mapping) munmap(mapping, mappingSize);
+}
+
+// Checks that a section of elemSize-byte elements lies inside the file on an 8-byte boundary
+static bool sectionFits(const LevelSection& s, size_t elemSize, size_t fileSize) {
+    if (s.offset % 8 != 0) return false;
+    return s.offset <= fileSize && s.count <= (fileSize - s.offset) / elemSize;
+}
+
+// Maps the file and checks the header. The sections are used in place: nothing is parsed or copied,
+// so load time does not grow with the map size
+bool Level::load(const char* path, int expectedTileSize) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open level file: " << path << "\n";
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(LevelHeader))) {
+        std::cerr << "Level file too small: " << path << "\n";
+        close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid after the descriptor is closed
+    if (data == MAP_FAILED) {
+        std::cerr << "Failed to map level file: " << path << "\n";
+        return false;
+    }
+
+    const LevelHeader* h = static_cast<const LevelHeader*>(data);
+    size_t cells = static_cast<size_t>(h->cols) * static_cast<size_t>(h->rows);
+    const char* error = nullptr;
+    if (std::memcmp(h->magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC)) != 0) error = "not a level file";
+    else if (h->version != LEVEL_VERSION) error = "unsupported version, rebake with make levels";
+    else if (h->fileSize != size) error = "truncated file";
+    else if (h->tileSize != expectedTileSize) error = "baked for a different tile size";
+    else if (h->cols <= 0 || h->rows <= 0 || h->layerCount <= 0) error = "empty grid";
+    else if (!sectionFits(h->tiles, 1, size) || h->tiles.count != cells * h->layerCount ||
+             !sectionFits(h->platforms, sizeof(Platform), size) ||
+             !sectionFits(h->platformRects, sizeof(SDL_Rect), size) || h->platformRects.count != h->platforms.count ||
+             !sectionFits(h->spawnSurfaces, sizeof(SpawnSurface), size) ||
+             !sectionFits(h->solidBits, sizeof(uint64_t), size) || h->solidBits.count != (cells + 63) / 64 ||
+             !sectionFits(h->navSurfaces, sizeof(NavSurface), size) ||
+             !sectionFits(h->navLinkStart, sizeof(int32_t), size) || h->navLinkStart.count != h->navSurfaces.count + 1 ||
+             !sectionFits(h->navLinks, sizeof(NavLink), size) ||
+             !sectionFits(h->navCells, sizeof(int32_t), size) || h->navCells.count != cells) {
+        error = "corrupt section table";
+    }
+    if (error) {
+        std::cerr << "Bad level file " << path << ": " << error << "\n";
+        munmap(data, size);
+        return false;
+    }
+
+    if (mapping) munmap(mapping, mappingSize);
+    mapping = data;
+    mappingSize = size;
+    header = h;
+    solid = static_cast<const uint64_t*>(section(h->solidBits));
+    return true;
+}
+
+// Whether a level is loaded
+bool Level::isLoaded() const {
+    return header != nullptr;
+}
+
+// Tile size in pixels
+int Level::getTileSize() const {
+    return header->tileSize;
+}
+
+// Grid width in tiles
+int Level::getCols() const {
+    return header->cols;
+}
+
+// Grid height in tiles
+int Level::getRows() const {
+    return header->rows;
+}
+
+// Entity width the spawn surfaces were baked for
+int Level::getSpawnWidth() const {
+    return header->spawnWidth;
+}
+
+// Entity height the spawn surfaces were baked for
+int Level::getSpawnHeight() const {
+    return header->spawnHeight;
+}
+
+// Tile ID at a cell of a layer (0 for empty)
+uint8_t Level::tileAt(int layer, int col, int row) const {
+    const uint8_t* tiles = static_cast<const uint8_t*>(section(header->tiles));
+    return tiles[(static_cast<size_t>(layer) * header->rows + row) * header->cols + col];
+}
+
+// Number of tile layers
+int Level::getLayerCount() const {
+    return header->layerCount;
+}
+
+// Platform rects merged from the collision layer
+std::span<const Platform> Level::getPlatforms() const {
+    return {static_cast<const Platform*>(section(header->platforms)), header->platforms.count};
+}
+
+// Pixel rect of each platform
+std::span<const SDL_Rect> Level::getPlatformRects() const {
+    return {static_cast<const SDL_Rect*>(section(header->platformRects)), header->platformRects.count};
+}
+
+// Collision bitset, one bit per tile in row-major order
+const uint64_t* Level::getSolidBits() const {
+    return solid;
+}
+
+// Spawn surface table for the baked spawn box
+std::span<const SpawnSurface> Level::getSpawnSurfaces() const {
+    return {static_cast<const SpawnSurface*>(section(header->spawnSurfaces)), header->spawnSurfaces.count};
+}
+
+// Walkable surfaces
+std::span<const NavSurface> Level::getNavSurfaces() const {
+    return {static_cast<const NavSurface*>(section(header->navSurfaces)), header->navSurfaces.count};
+}
+
+// Links leaving a nav surface
+std::span<const NavLink> Level::getNavLinks(int surface) const {
+    const int32_t* start = static_cast<const int32_t*>(section(header->navLinkStart));
+    const NavLink* links = static_cast<const NavLink*>(section(header->navLinks));
+    return {links + start[surface], static_cast<size_t>(start[surface + 1] - start[surface])};
+}
+
+// Nav surface standing in a tile cell, or -1
+int Level::navSurfaceAt(int col, int row) const {
+    if (col < 0 || row < 0 || col >= header->cols || row >= header->rows) return -1;
+    const int32_t* cells = static_cast<const int32_t*>(section(header->navCells));
+    return cells[static_cast<size_t>(row) * header->cols + col];
+}
+
+// Pointer to the start of a section
+const void* Level::section(const LevelSection& s) const {
+    return static_cast<const char*>(mapping) + s.offset;
+}
@@ -0,0 +1,199 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include "SpawnScheduler.h"
+
+// Binary level format. A .lvl file is a LevelHeader followed by the sections it points to, all baked
+// offline by levelbake. Every section is a plain array, so loading maps the file and points into it.
+const char LEVEL_MAGIC[4] = {'T', 'G', 'L', 'V'}; // File signature
+const uint32_t LEVEL_VERSION = 2; // Bumped whenever the layout changes
+
+// Platform rectangle in tile units
+struct Platform {
+    int32_t x, y, width, height; // Position and dimensions in tile units
+};
+
+// Path of a moving platform: it travels back and forth between two top-left corners (pixels)
+struct MoverPath {
+    int32_t startX, startY; // First end point
+    int32_t endX, endY; // Second end point
+    int32_t width, height; // Size in pixels
+    float speed; // Pixels per tick
+};
+
+// Walkable run of tiles: empty cells in one row with solid ground directly below
+struct NavSurface {
+    int32_t row; // Row the walker stands in
+    int32_t minCol; // First walkable column
+    int32_t maxCol; // Last walkable column
+};
+
+// Ways to get from one nav surface to another
+enum NavMove : int32_t { NAV_WALK_OFF = 0, NAV_JUMP = 1 };
+
+// Directed edge between nav surfaces
+struct NavLink {
+    int32_t to; // Target surface index
+    int32_t move; // NavMove needed to get there
+};
+
+// Location and element count of one section
+struct LevelSection {
+    uint32_t offset; // Byte offset from the start of the file
+    uint32_t count; // Number of elements
+};
+
+// Fixed-size file header
+struct LevelHeader {
+    char magic[4]; // LEVEL_MAGIC
+    uint32_t version; // LEVEL_VERSION
+    uint32_t fileSize; // Total file size in bytes
+    int32_t tileSize; // Tile size in pixels the level was baked for
+    int32_t cols, rows; // Grid size in tiles
+    int32_t layerCount; // Number of tile layers; layer 0 is the collision layer
+    int32_t spawnWidth, spawnHeight; // Entity box the spawn surfaces were baked for
+    LevelSection tiles; // uint8_t tile IDs, layerCount * rows * cols, row-major per layer
+    LevelSection platforms; // Platform rects merged from the collision layer
+    LevelSection platformRects; // SDL_Rect pixel rect of each platform
+    LevelSection spawnSurfaces; // SpawnSurface table for the spawn box
+    LevelSection solidBits; // uint64_t words, one bit per tile (row-major), set when solid
+    LevelSection navSurfaces; // NavSurface table
+    LevelSection navLinkStart; // int32_t per surface plus one: links of surface i are [start[i], start[i + 1])
+    LevelSection navLinks; // NavLink table
+    LevelSection navCells; // int32_t per tile: index of the nav surface standing in that cell, or -1
+};
+
+// Read-only view of a memory-mapped level file
+class Level {
+public:
+    // Default constructor (no level loaded)
+    Level();
+
+    // Unmaps the file
+    ~Level();
+
+    Level(const Level&) = delete;
+    Level& operator=(const Level&) = delete;
+
+    // Maps a baked level file and validates its header; returns false (and logs) on any error
+    bool load(const char* path, int expectedTileSize);
+
+    // Whether a level is loaded
+    bool isLoaded() const;
+
+    // Tile size in pixels
+    int getTileSize() const;
+
+    // Grid size in tiles
+    int getCols() const;
+    int getRows() const;
+
+    // Entity box the spawn surfaces were baked for
+    int getSpawnWidth() const;
+    int getSpawnHeight() const;
+
+    // Tile ID at a cell of a layer (0 for empty)
+    uint8_t tileAt(int layer, int col, int row) const;
+
+    // Number of tile layers
+    int getLayerCount() const;
+
+    // Whether a tile cell is solid; cells outside the grid are empty
+    bool solidTile(int col, int row) const {
+        if (col < 0 || row < 0 || col >= header->cols || row >= header->rows) return false;
+        size_t bit = static_cast<size_t>(row) * header->cols + col;
+        return (solid[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    // Baked tables
+    std::span<const Platform> getPlatforms() const;
+    std::span<const SDL_Rect> getPlatformRects() const;
+    const uint64_t* getSolidBits() const;
+    std::span<const SpawnSurface> getSpawnSurfaces() const;
+    std::span<const NavSurface> getNavSurfaces() const;
+
+    // Links leaving a nav surface
+    std::span<const NavLink> getNavLinks(int surface) const;
+
+    // Nav surface standing in a tile cell, or -1
+    int navSurfaceAt(int col, int row) const;
+
+    // Size of the mapped file in bytes (0 when nothing is loaded)
+    size_t getFileSize() const { return mappingSize; }
+
+private:
+    // Pointer to the start of a section
+    const void* section(const LevelSection& s) const;
+
+    void* mapping; // Start of the mapped file
+    size_t mappingSize; // Size of the mapping in bytes
+    const LevelHeader* header; // Header at the start of the mapping
+    const uint64_t* solid; // Collision bitset
+};
+
+// Compile-time helpers for levels built into the binary
+
+// Pixel rect of each platform
+template <size_t N>
+constexpr std::array<SDL_Rect, N> platformPixelRects(const Platform (&platforms)[N], int tileSize) {
+    std::array<SDL_Rect, N> rects{};
+    for (size_t i = 0; i < N; i++) {
+        rects[i] = {platforms[i].x * tileSize, platforms[i].y * tileSize, platforms[i].width * tileSize, platforms[i].height * tileSize};
+    }
+    return rects;
+}
+
+// Collision bitset (one bit per tile, row-major) of a COLS x ROWS grid
+template <int COLS, int ROWS, size_t N>
+constexpr std::array<uint64_t, (COLS * ROWS + 63) / 64> solidBitset(const Platform (&platforms)[N]) {
+    std::array<uint64_t, (COLS * ROWS + 63) / 64> bits{};
+    for (const auto& p : platforms) {
+        for (int r = p.y; r < p.y + p.height; r++) {
+            for (int c = p.x; c < p.x + p.width; c++) {
+                if (c < 0 || r < 0 || c >= COLS || r >= ROWS) continue;
+                size_t bit = static_cast<size_t>(r) * COLS + c;
+                bits[bit >> 6] |= uint64_t(1) << (bit & 63);
+            }
+        }
+    }
+    return bits;
+}
+
+// Whether any two platforms share a tile
+template <size_t N>
+constexpr bool platformsOverlap(const Platform (&platforms)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i + 1; j < N; j++) {
+            const Platform& a = platforms[i];
+            const Platform& b = platforms[j];
+            if (a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height) return true;
+        }
+    }
+    return false;
+}
+
+// Whether every moving platform's path stays inside a width x height pixel area
+template <size_t N>
+constexpr bool moversInside(const MoverPath (&movers)[N], int width, int height) {
+    for (const auto& m : movers) {
+        if (m.width <= 0 || m.height <= 0 || m.speed <= 0) return false;
+        if (std::min(m.startX, m.endX) < 0 || std::min(m.startY, m.endY) < 0) return false;
+        if (std::max(m.startX, m.endX) + m.width > width || std::max(m.startY, m.endY) + m.height > height) return false;
+    }
+    return true;
+}
+
+// Whether every platform is non-empty and lies inside a cols x rows grid
+template <size_t N>
+constexpr bool platformsInside(const Platform (&platforms)[N], int cols, int rows) {
+    for (const auto& p : platforms) {
+        if (p.width <= 0 || p.height <= 0 || p.x < 0 || p.y < 0 || p.x + p.width > cols || p.y + p.height > rows) return false;
+    }
+    return true;
+}
+
+#endif
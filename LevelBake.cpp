@@ -0,0 +1,249 @@
+// Offline level baker: turns a text level description into a binary .lvl file (see Level.h).
+// Usage: levelbake <input.txt> <output.lvl>
+//
+// Input format (lines starting with '#' before the first layer are comments):
+//   tile_size <pixels>
+//   spawn_box <width> <height>            entity box the spawn surfaces are computed for
+//   spawn_bounds <x> <y> <width> <height> pixel area spawns must stay inside
+//   jump <force> <gravity> <max_speed>    physics used to decide which nav surfaces are reachable
+//   layer                                 starts a tile layer; the first layer is the collision layer
+//   <one line of tiles per row>           '.' empty, '#' platform tile (ID 1), '1'-'9' tile IDs
+#include "Level.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Parsed text level
+struct LevelSource {
+    int tileSize = 32; // Tile size in pixels
+    int spawnWidth = 32, spawnHeight = 32; // Spawn box
+    SDL_Rect spawnBounds = {0, 0, 0, 0}; // Spawn area (defaults to the whole grid)
+    float jumpForce = 13.0f, gravity = 0.5f, maxSpeed = 5.0f; // Jump physics
+    std::vector<std::vector<std::string>> layers; // Tile rows of each layer
+};
+
+// Converts a tile character to a tile ID, or -1 if invalid
+static int tileId(char c) {
+    if (c == '.') return 0;
+    if (c == '#') return 1;
+    if (c >= '1' && c <= '9') return c - '0';
+    return -1;
+}
+
+// Reads the text description
+static bool readSource(const char* path, LevelSource& src) {
+    std::ifstream inFile(path);
+    if (!inFile.is_open()) {
+        std::cerr << "Failed to open level source: " << path << "\n";
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(inFile, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty()) continue;
+        if (line[0] == '#' && src.layers.empty()) continue; // Comment (inside layers '#' is a tile)
+        std::istringstream fields(line);
+        std::string key;
+        fields >> key;
+        bool ok = true;
+        if (key == "tile_size") ok = static_cast<bool>(fields >> src.tileSize);
+        else if (key == "spawn_box") ok = static_cast<bool>(fields >> src.spawnWidth >> src.spawnHeight);
+        else if (key == "spawn_bounds") ok = static_cast<bool>(fields >> src.spawnBounds.x >> src.spawnBounds.y >> src.spawnBounds.w >> src.spawnBounds.h);
+        else if (key == "jump") ok = static_cast<bool>(fields >> src.jumpForce >> src.gravity >> src.maxSpeed);
+        else if (key == "layer") src.layers.emplace_back();
+        else if (!src.layers.empty()) src.layers.back().push_back(line); // Tile row
+        else ok = false;
+        if (!ok) {
+            std::cerr << path << ":" << lineNumber << ": bad line: " << line << "\n";
+            return false;
+        }
+    }
+    if (src.layers.empty() || src.layers[0].empty()) {
+        std::cerr << path << ": no tile layers\n";
+        return false;
+    }
+    size_t cols = src.layers[0][0].size();
+    for (const auto& layer : src.layers) {
+        if (layer.size() != src.layers[0].size()) {
+            std::cerr << path << ": layers have different row counts\n";
+            return false;
+        }
+        for (const auto& row : layer) {
+            if (row.size() != cols) {
+                std::cerr << path << ": rows have different lengths\n";
+                return false;
+            }
+            for (char c : row) {
+                if (tileId(c) < 0) {
+                    std::cerr << path << ": invalid tile character '" << c << "'\n";
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Horizontal distance covered by a full-speed jump by the time it comes back down to a ledge rise pixels up,
+// or -1 if the jump never gets that high
+static float jumpReach(const LevelSource& src, float rise) {
+    float y = 0.0f, vy = src.jumpForce, x = 0.0f, apex = 0.0f;
+    for (int tick = 0; tick < 1000; tick++) {
+        y += vy;
+        x += src.maxSpeed;
+        vy -= src.gravity;
+        apex = std::max(apex, y);
+        if (vy < 0 && y <= rise) return apex >= rise ? x : -1.0f;
+    }
+    return -1.0f;
+}
+
+// Appends a section to the output buffer on an 8-byte boundary
+template <typename T>
+static LevelSection appendSection(std::vector<char>& out, const std::vector<T>& items) {
+    out.resize((out.size() + 7) & ~static_cast<size_t>(7), 0);
+    LevelSection s = {static_cast<uint32_t>(out.size()), static_cast<uint32_t>(items.size())};
+    const char* bytes = reinterpret_cast<const char*>(items.data());
+    out.insert(out.end(), bytes, bytes + items.size() * sizeof(T));
+    return s;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Usage: levelbake <input.txt> <output.lvl>\n";
+        return 1;
+    }
+    LevelSource src;
+    if (!readSource(argv[1], src)) return 1;
+
+    int rows = static_cast<int>(src.layers[0].size());
+    int cols = static_cast<int>(src.layers[0][0].size());
+    size_t cells = static_cast<size_t>(rows) * cols;
+    if (src.spawnBounds.w == 0) src.spawnBounds = {0, 0, cols * src.tileSize, rows * src.tileSize};
+
+    // Tile layers
+    std::vector<uint8_t> tiles;
+    for (const auto& layer : src.layers) {
+        for (const auto& row : layer) {
+            for (char c : row) tiles.push_back(static_cast<uint8_t>(tileId(c)));
+        }
+    }
+    auto solidAt = [&](int c, int r) {
+        return c >= 0 && r >= 0 && c < cols && r < rows && tiles[static_cast<size_t>(r) * cols + c] != 0;
+    };
+
+    // Collision bitset
+    std::vector<uint64_t> solidBits((cells + 63) / 64, 0);
+    for (size_t i = 0; i < cells; i++) {
+        if (tiles[i]) solidBits[i >> 6] |= uint64_t(1) << (i & 63);
+    }
+
+    // Platforms: greedily merge solid tiles into rows, then stack identical rows
+    std::vector<Platform> platforms;
+    std::vector<uint8_t> used(cells, 0);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            if (!solidAt(c, r) || used[r * cols + c]) continue;
+            int w = 1;
+            while (solidAt(c + w, r) && !used[r * cols + c + w]) w++;
+            int h = 1;
+            for (bool full = true; full && r + h < rows; ) {
+                for (int i = 0; i < w && full; i++) full = solidAt(c + i, r + h) && !used[(r + h) * cols + c + i];
+                if (full) h++;
+            }
+            for (int y = r; y < r + h; y++) {
+                for (int x = c; x < c + w; x++) used[y * cols + x] = 1;
+            }
+            platforms.push_back({c, r, w, h});
+        }
+    }
+
+    // Spawn surfaces, computed by the same code the game used to run at startup
+    std::vector<SDL_Rect> solidRects;
+    for (const auto& p : platforms) {
+        solidRects.push_back({p.x * src.tileSize, p.y * src.tileSize, p.width * src.tileSize, p.height * src.tileSize});
+    }
+    SpawnScheduler spawner(0.0);
+    spawner.build(solidRects, src.spawnWidth, src.spawnHeight, src.spawnBounds);
+    const std::vector<SpawnSurface>& spawnSurfaces = spawner.getSurfaces();
+
+    // Nav surfaces: runs of empty cells with solid ground below
+    std::vector<NavSurface> navSurfaces;
+    std::vector<int32_t> navCells(cells, -1);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            if (solidAt(c, r) || !solidAt(c, r + 1)) continue;
+            int start = c;
+            while (c + 1 < cols && !solidAt(c + 1, r) && solidAt(c + 1, r + 1)) c++;
+            for (int x = start; x <= c; x++) navCells[r * cols + x] = static_cast<int32_t>(navSurfaces.size());
+            navSurfaces.push_back({r, start, c});
+        }
+    }
+
+    // Nav links: walking off an edge lands on the first surface below; jumps reach higher or level surfaces within range
+    std::vector<int32_t> navLinkStart;
+    std::vector<NavLink> navLinks;
+    for (size_t a = 0; a < navSurfaces.size(); a++) {
+        navLinkStart.push_back(static_cast<int32_t>(navLinks.size()));
+        const NavSurface& from = navSurfaces[a];
+        for (int edge : {from.minCol - 1, from.maxCol + 1}) {
+            if (edge < 0 || edge >= cols || solidAt(edge, from.row)) continue;
+            for (int r = from.row + 1; r < rows && !solidAt(edge, r); r++) {
+                int target = navCells[r * cols + edge];
+                if (target >= 0) {
+                    bool known = navLinks.size() > static_cast<size_t>(navLinkStart.back()) && navLinks.back().to == target;
+                    if (!known) navLinks.push_back({target, NAV_WALK_OFF}); // Both edges can land on the same surface
+                    break;
+                }
+            }
+        }
+        for (size_t b = 0; b < navSurfaces.size(); b++) {
+            const NavSurface& to = navSurfaces[b];
+            if (b == a || to.row > from.row) continue;
+            int gapCols = std::max({0, to.minCol - from.maxCol - 1, from.minCol - to.maxCol - 1});
+            float reach = jumpReach(src, static_cast<float>((from.row - to.row) * src.tileSize));
+            if (reach >= 0 && gapCols * src.tileSize <= reach) navLinks.push_back({static_cast<int32_t>(b), NAV_JUMP});
+        }
+    }
+    navLinkStart.push_back(static_cast<int32_t>(navLinks.size()));
+
+    // Write header and sections
+    LevelHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, LEVEL_MAGIC, sizeof(LEVEL_MAGIC));
+    header.version = LEVEL_VERSION;
+    header.tileSize = src.tileSize;
+    header.cols = cols;
+    header.rows = rows;
+    header.layerCount = static_cast<int32_t>(src.layers.size());
+    header.spawnWidth = src.spawnWidth;
+    header.spawnHeight = src.spawnHeight;
+    std::vector<char> out(sizeof(LevelHeader), 0);
+    header.tiles = appendSection(out, tiles);
+    header.platforms = appendSection(out, platforms);
+    header.platformRects = appendSection(out, solidRects);
+    header.spawnSurfaces = appendSection(out, spawnSurfaces);
+    header.solidBits = appendSection(out, solidBits);
+    header.navSurfaces = appendSection(out, navSurfaces);
+    header.navLinkStart = appendSection(out, navLinkStart);
+    header.navLinks = appendSection(out, navLinks);
+    header.navCells = appendSection(out, navCells);
+    header.fileSize = static_cast<uint32_t>(out.size());
+    std::memcpy(out.data(), &header, sizeof(header));
+
+    std::ofstream outFile(argv[2], std::ios::binary);
+    if (!outFile.is_open() || !outFile.write(out.data(), out.size())) {
+        std::cerr << "Failed to write level file: " << argv[2] << "\n";
+        return 1;
+    }
+    std::cout << "Baked " << argv[2] << ": " << cols << "x" << rows << " tiles, " << platforms.size() << " platforms, "
+              << spawnSurfaces.size() << " spawn surfaces, " << navSurfaces.size() << " nav surfaces, "
+              << navLinks.size() << " nav links\n";
+    return 0;
+}
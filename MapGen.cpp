@@ -0,0 +1,127 @@
+#include "MapGen.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+// Map generation limits
+static const int MIN_COLS = 8, MIN_ROWS = 10; // Smallest grid that fits the ground and a platform with headroom
+static const int MAX_TILES = 16 * 1024 * 1024; // Largest grid (tiles)
+static const int GROUND_ROWS = 2; // Rows of ground along the bottom
+static const int MIN_WIDTH = 3, MAX_WIDTH = 10; // Floating platform width range (tiles)
+static const int HEADROOM = 3; // Empty rows kept above every platform so entities can stand on it
+static const int ATTEMPTS_PER_PLATFORM = 8; // Placement tries per wanted platform before giving up
+
+// splitmix64: a fixed algorithm, unlike the standard distributions, whose output differs between library vendors
+static uint64_t nextRandom(uint64_t& state) {
+    uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform integer in [lo, hi]
+static int randomRange(uint64_t& state, int lo, int hi) {
+    return lo + static_cast<int>(nextRandom(state) % static_cast<uint64_t>(hi - lo + 1));
+}
+
+// Generates a map; returns false (and logs) if the settings are out of range
+bool generateMap(const MapParams& params, GeneratedMap& map) {
+    if (params.cols < MIN_COLS || params.rows < MIN_ROWS || static_cast<int64_t>(params.cols) * params.rows > MAX_TILES ||
+        params.density < 0.0f || params.tileSize <= 0) {
+        std::cerr << "Bad map settings: " << params.cols << "x" << params.rows << " tiles, density " << params.density << "\n";
+        return false;
+    }
+    int cols = params.cols, rows = params.rows;
+    map.params = params;
+    map.platforms.clear();
+    map.rects.clear();
+    map.solidBits.assign((static_cast<size_t>(cols) * rows + 63) / 64, 0);
+    std::vector<uint8_t> reserved(static_cast<size_t>(cols) * rows, 0); // Platform tiles plus the margin kept around them
+
+    auto place = [&](const Platform& p) {
+        for (int r = p.y; r < p.y + p.height; r++) {
+            for (int c = p.x; c < p.x + p.width; c++) {
+                size_t bit = static_cast<size_t>(r) * cols + c;
+                map.solidBits[bit >> 6] |= uint64_t(1) << (bit & 63);
+            }
+        }
+        int r0 = std::max(0, p.y - HEADROOM), r1 = std::min(rows - 1, p.y + p.height); // Headroom above, a gap below
+        int c0 = std::max(0, p.x - 1), c1 = std::min(cols - 1, p.x + p.width); // A gap either side
+        for (int r = r0; r <= r1; r++) {
+            for (int c = c0; c <= c1; c++) reserved[static_cast<size_t>(r) * cols + c] = 1;
+        }
+        map.platforms.push_back(p);
+    };
+    place({0, rows - GROUND_ROWS, cols, GROUND_ROWS});
+
+    uint64_t state = params.seed;
+    size_t wanted = static_cast<size_t>(params.density * static_cast<float>(cols) * static_cast<float>(rows) / 1000.0f);
+    size_t attempts = wanted * ATTEMPTS_PER_PLATFORM;
+    int maxWidth = std::min(MAX_WIDTH, cols - 2);
+    for (size_t i = 0; i < attempts && map.platforms.size() <= wanted; i++) {
+        Platform p;
+        p.width = randomRange(state, MIN_WIDTH, maxWidth);
+        p.height = randomRange(state, 0, 3) == 0 ? 2 : 1; // Mostly thin ledges, some thick blocks
+        p.x = randomRange(state, 1, cols - p.width - 1);
+        p.y = randomRange(state, HEADROOM, rows - GROUND_ROWS - HEADROOM - p.height); // Leave room above the ground too
+        bool free = true;
+        for (int r = p.y - HEADROOM; r < p.y + p.height + 1 && free; r++) {
+            for (int c = p.x - 1; c < p.x + p.width + 1 && free; c++) free = !reserved[static_cast<size_t>(r) * cols + c];
+        }
+        if (free) place(p);
+    }
+    if (map.platforms.size() <= wanted) {
+        std::cerr << "Map generator placed " << map.platforms.size() - 1 << " of " << wanted << " platforms (grid too crowded)\n";
+    }
+
+    for (const auto& p : map.platforms) {
+        map.rects.push_back({p.x * params.tileSize, p.y * params.tileSize, p.width * params.tileSize, p.height * params.tileSize});
+    }
+    return true;
+}
+
+// Terrain viewing a generated map's tables
+Terrain makeTerrain(const GeneratedMap& map) {
+    return Terrain(map.platforms, map.rects, map.solidBits.data(), map.params.cols, map.params.rows, map.params.tileSize);
+}
+
+// FNV-1a hash of the collision bitset
+uint64_t mapChecksum(const GeneratedMap& map) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (uint64_t word : map.solidBits) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (word >> (i * 8)) & 0xFF;
+            hash *= 0x100000001B3ull;
+        }
+    }
+    return hash;
+}
+
+// Writes the map as a levelbake text description
+bool writeMapSource(const GeneratedMap& map, const char* path) {
+    std::ofstream outFile(path);
+    if (!outFile.is_open()) {
+        std::cerr << "Failed to open map file for writing: " << path << "\n";
+        return false;
+    }
+    const MapParams& p = map.params;
+    outFile << "# Generated by mapgen: seed " << p.seed << ", " << p.cols << "x" << p.rows << " tiles, density " << p.density
+            << ", checksum " << std::hex << mapChecksum(map) << std::dec << "\n";
+    outFile << "tile_size " << p.tileSize << "\n";
+    outFile << "spawn_box 32 32\n";
+    outFile << "layer\n";
+    std::string row(p.cols, '.');
+    for (int r = 0; r < p.rows; r++) {
+        for (int c = 0; c < p.cols; c++) {
+            size_t bit = static_cast<size_t>(r) * p.cols + c;
+            row[c] = (map.solidBits[bit >> 6] >> (bit & 63)) & 1 ? '#' : '.';
+        }
+        outFile << row << "\n";
+    }
+    if (!outFile) {
+        std::cerr << "Failed to write map file: " << path << "\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef MAPGEN_H
+#define MAPGEN_H
+
+#include <cstdint>
+#include <vector>
+#include "Level.h"
+#include "Terrain.h"
+
+// Settings for a generated stress map. The same settings give the same map on every machine and compiler
+struct MapParams {
+    uint64_t seed = 1; // Random seed
+    int cols = 100, rows = 60; // Grid size in tiles
+    float density = 12.0f; // Floating platforms per 1000 tiles (the built-in level has about 11)
+    int tileSize = 32; // Tile size in pixels
+};
+
+// Procedurally generated platformer map: ground along the bottom plus non-overlapping floating platforms
+// with room to stand on each. Owns the tables a Terrain views, so it must outlive any Terrain made from it
+struct GeneratedMap {
+    MapParams params; // Settings it was generated from
+    std::vector<Platform> platforms; // Platforms in tile units, ground first
+    std::vector<SDL_Rect> rects; // Pixel rect of each platform
+    std::vector<uint64_t> solidBits; // Collision bitset, one bit per tile (row-major)
+};
+
+// Generates a map; returns false (and logs) if the settings are out of range
+bool generateMap(const MapParams& params, GeneratedMap& map);
+
+// Terrain viewing a generated map's tables
+Terrain makeTerrain(const GeneratedMap& map);
+
+// FNV-1a hash of the collision bitset, printed next to benchmark results to show two runs used the same map
+uint64_t mapChecksum(const GeneratedMap& map);
+
+// Writes the map as a levelbake text description (see LevelBake.cpp) so it can be baked and loaded with Level
+bool writeMapSource(const GeneratedMap& map, const char* path);
+
+#endif
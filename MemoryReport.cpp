@@ -0,0 +1,98 @@
+#include "MemoryReport.h"
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <sys/resource.h>
+#include <unistd.h>
+
+// Tag names, in enum order
+static const char* const TAG_NAMES[MEM_TAG_COUNT] = {
+    "Textures", "Fonts", "Entities", "AI", "Terrain", "Pools", "Buffers"};
+
+// Constructor (empty report)
+MemoryReport::MemoryReport() : totals{} {}
+
+// Forgets every item
+void MemoryReport::clear() {
+    items.clear();
+    std::fill(std::begin(totals), std::end(totals), 0);
+}
+
+// Adds an item
+void MemoryReport::add(MemoryTag tag, const std::string& name, size_t bytes, size_t count) {
+    items.push_back({tag, name, bytes, count});
+    totals[tag] += bytes;
+}
+
+// Adds a texture
+void MemoryReport::addTexture(const std::string& name, SDL_Texture* texture) {
+    if (texture) add(MEM_TEXTURES, name, textureBytes(texture));
+}
+
+// Bytes reported under a tag
+size_t MemoryReport::total(MemoryTag tag) const {
+    return totals[tag];
+}
+
+// Bytes reported in total
+size_t MemoryReport::total() const {
+    size_t sum = 0;
+    for (size_t bytes : totals) sum += bytes;
+    return sum;
+}
+
+// Writes the per-tag totals, then every item from largest to smallest
+void MemoryReport::print(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags(); // Restored on the way out
+    std::streamsize precision = out.precision();
+    size_t all = total();
+    out << "Memory by category (" << all / 1024 << " KB reported, " << currentRssBytes() / 1024 << " KB resident, "
+        << peakRssBytes() / 1024 << " KB peak):\n";
+    for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+        double share = all ? 100.0 * totals[tag] / all : 0.0;
+        out << "  " << std::left << std::setw(10) << TAG_NAMES[tag] << std::right << std::setw(12) << totals[tag] / 1024
+            << " KB " << std::fixed << std::setprecision(1) << std::setw(5) << share << "%\n";
+    }
+    std::vector<const MemoryItem*> sorted;
+    for (const auto& item : items) sorted.push_back(&item);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const MemoryItem* a, const MemoryItem* b) { return a->bytes > b->bytes; });
+    out << "Items:\n";
+    for (const MemoryItem* item : sorted) {
+        out << "  " << std::left << std::setw(10) << TAG_NAMES[item->tag] << std::right << std::setw(12) << item->bytes
+            << " B  " << item->name;
+        if (item->count > 1) out << " (" << item->count << ", " << item->bytes / item->count << " B each)";
+        out << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// Name of a tag
+const char* memoryTagName(MemoryTag tag) {
+    return TAG_NAMES[tag];
+}
+
+// Size of a texture's pixels
+size_t textureBytes(SDL_Texture* texture) {
+    Uint32 format = 0;
+    int w = 0, h = 0;
+    if (!texture || SDL_QueryTexture(texture, &format, nullptr, &w, &h) != 0) return 0;
+    return static_cast<size_t>(w) * h * SDL_BYTESPERPIXEL(format);
+}
+
+// Resident set size now, from /proc/self/statm (Linux only)
+size_t currentRssBytes() {
+    FILE* statm = std::fopen("/proc/self/statm", "r");
+    if (!statm) return 0;
+    unsigned long pages = 0, resident = 0;
+    int fields = std::fscanf(statm, "%lu %lu", &pages, &resident);
+    std::fclose(statm);
+    return fields == 2 ? static_cast<size_t>(resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+}
+
+// Peak resident set size (getrusage reports kilobytes on Linux)
+size_t peakRssBytes() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;
+}
@@ -0,0 +1,80 @@
+#ifndef MEMORYREPORT_H
+#define MEMORYREPORT_H
+
+#include <SDL2/SDL.h>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Memory accounting. Each subsystem reports what it holds (container capacities, texture sizes) into a
+// MemoryReport under a category tag; the game fills one on demand for the F2 overlay and the console breakdown.
+// Sizes are what the game asked for, not allocator overhead, so they are compared against RSS to spot the gap
+
+// Categories memory is reported under
+enum MemoryTag {
+    MEM_TEXTURES, // Sprites, backgrounds and render targets (pixels x bytes per pixel)
+    MEM_FONTS, // Open fonts (estimated from the font file size)
+    MEM_ENTITIES, // Zombie, food and player storage
+    MEM_AI, // Behavior tree blackboards and jump tables
+    MEM_TERRAIN, // Tile bitset, empty runs and the mapped level file
+    MEM_POOLS, // Handle tables and free lists
+    MEM_BUFFERS, // Scratch buffers: sort keys, frame arena, dirty lists
+    MEM_TAG_COUNT
+};
+
+// One reported allocation (or group of like allocations)
+struct MemoryItem {
+    MemoryTag tag; // Category
+    std::string name; // What it is, for the breakdown
+    size_t bytes; // Total size in bytes
+    size_t count; // Number of objects it covers (textures, zombies, ...)
+};
+
+// Memory reported by the subsystems at one point in time
+class MemoryReport {
+public:
+    // Constructor (empty report)
+    MemoryReport();
+
+    // Forgets every item
+    void clear();
+
+    // Adds an item
+    void add(MemoryTag tag, const std::string& name, size_t bytes, size_t count = 1);
+
+    // Adds a texture, sized from its format and dimensions (nothing for a null texture)
+    void addTexture(const std::string& name, SDL_Texture* texture);
+
+    // Bytes reported under a tag, and in total
+    size_t total(MemoryTag tag) const;
+    size_t total() const;
+
+    // Reported items, in the order they were added
+    const std::vector<MemoryItem>& getItems() const { return items; }
+
+    // Writes the per-tag totals, then every item from largest to smallest
+    void print(std::ostream& out) const;
+
+private:
+    std::vector<MemoryItem> items; // Reported items
+    size_t totals[MEM_TAG_COUNT]; // Bytes per tag
+};
+
+// Name of a tag for the overlay and breakdown
+const char* memoryTagName(MemoryTag tag);
+
+// Size of a texture's pixels: width x height x bytes per pixel of its format (0 for null)
+size_t textureBytes(SDL_Texture* texture);
+
+// Heap bytes a vector has reserved
+template <typename T>
+size_t vectorBytes(const std::vector<T>& v) {
+    return v.capacity() * sizeof(T);
+}
+
+// Resident set size of the process now and at its peak, in bytes (0 where the platform does not say)
+size_t currentRssBytes();
+size_t peakRssBytes();
+
+#endif
@@ -0,0 +1,262 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdarg>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+static const int FRAME_WINDOW = 600; // Frame times kept for the quantiles (10 seconds at 60 FPS)
+static const int QUANTILE_FRAMES = 60; // Frames between quantile and rate refreshes
+static const int ACCEPT_POLL_MS = 200; // How often the server thread checks for a stop
+static const int REQUEST_WAIT_MS = 50; // How long to wait for a request line before answering anyway
+static const size_t RESPONSE_BYTES = 8192; // Response buffer; the metrics fit in well under half of it
+
+// Everything a scrape reports, copied by value between the threads
+struct MetricsSnapshot {
+    uint64_t frames; // Frames since start
+    uint64_t ticks; // Simulation ticks since start
+    uint64_t saves; // Saves since start
+    double saveSeconds; // Time spent saving since start
+    double lastSaveSeconds; // Time the last save took
+    double tickRate; // Ticks per second over the last refresh interval
+    double frameRate; // Frames per second over the last refresh interval
+    double frameQuantiles[3]; // Frame time at the 50th, 90th and 99th percentile of the window
+    double frameMax; // Slowest frame in the window
+    MetricsGauges gauges; // Game gauges of the last frame
+};
+
+static const double QUANTILES[3] = {0.5, 0.9, 0.99};
+
+// Triple buffer: the game thread fills its back slot and swaps it into the middle, the server thread swaps a
+// fresh middle into its front slot. Neither ever waits, and no slot is written while it is being read
+static MetricsSnapshot slots[3];
+static std::atomic<int> middle{1}; // Middle slot index, with FRESH_BIT set when it holds an unread snapshot
+static const int FRESH_BIT = 4;
+static int backSlot = 0; // Game thread only
+static int frontSlot = 2; // Server thread only
+
+// Game thread state
+static MetricsSnapshot current = {}; // Snapshot being built
+static float frameTimes[FRAME_WINDOW]; // Last frame times in seconds, a ring
+static float sortedTimes[FRAME_WINDOW]; // Scratch copy for the quantiles
+static int frameTimeCount = 0; // Frame times recorded, capped at FRAME_WINDOW
+static int frameTimeNext = 0; // Next ring slot
+static std::chrono::steady_clock::time_point lastFrameEnd; // End of the previous frame
+static bool frameStarted = false; // Whether lastFrameEnd belongs to the current game
+static std::chrono::steady_clock::time_point lastRefresh; // Time of the last quantile refresh
+static uint64_t refreshFrames = 0; // Frames at the last refresh
+static uint64_t refreshTicks = 0; // Ticks at the last refresh
+static int framesSinceRefresh = 0; // Frames since the last refresh
+
+// Server state
+static std::thread server; // Accepts and answers scrapes
+static std::atomic<bool> stopping{false}; // Set to end the server thread
+static int listenFd = -1; // Listening socket
+static sockaddr_un address; // Socket path, removed on stop
+static bool running = false; // Whether the server thread is running
+
+// Hands the snapshot being built to the server thread
+static void publish() {
+    slots[backSlot] = current;
+    backSlot = middle.exchange(backSlot | FRESH_BIT, std::memory_order_acq_rel) & ~FRESH_BIT;
+}
+
+// Latest published snapshot (server thread)
+static const MetricsSnapshot& latest() {
+    if (middle.load(std::memory_order_relaxed) & FRESH_BIT) {
+        frontSlot = middle.exchange(frontSlot, std::memory_order_acq_rel) & ~FRESH_BIT;
+    }
+    return slots[frontSlot];
+}
+
+// Appends printf-style text to the response, stopping quietly at the end of the buffer
+static void append(char* buffer, size_t& length, const char* format, ...) __attribute__((format(printf, 3, 4)));
+static void append(char* buffer, size_t& length, const char* format, ...) {
+    if (length >= RESPONSE_BYTES) return;
+    va_list args;
+    va_start(args, format);
+    int written = std::vsnprintf(buffer + length, RESPONSE_BYTES - length, format, args);
+    va_end(args);
+    if (written > 0) length = std::min(RESPONSE_BYTES - 1, length + static_cast<size_t>(written)); // Less the terminator
+}
+
+// Appends one metric with its help and type lines
+static void appendMetric(char* buffer, size_t& length, const char* name, const char* type, const char* help, double value) {
+    append(buffer, length, "# HELP %s %s\n# TYPE %s %s\n%s %.17g\n", name, help, name, type, name, value);
+}
+
+// Formats a snapshot in the Prometheus text format; returns the length
+static size_t formatMetrics(const MetricsSnapshot& s, char* buffer) {
+    size_t length = 0;
+    appendMetric(buffer, length, "game_frames_total", "counter", "Frames rendered.", static_cast<double>(s.frames));
+    appendMetric(buffer, length, "game_ticks_total", "counter", "Simulation ticks run.", static_cast<double>(s.ticks));
+    appendMetric(buffer, length, "game_tick_rate", "gauge", "Simulation ticks per second over the last second.", s.tickRate);
+    appendMetric(buffer, length, "game_frame_rate", "gauge", "Frames per second over the last second.", s.frameRate);
+    append(buffer, length, "# HELP game_frame_seconds Frame time over the last %d frames.\n# TYPE game_frame_seconds summary\n", FRAME_WINDOW);
+    for (int q = 0; q < 3; q++) append(buffer, length, "game_frame_seconds{quantile=\"%g\"} %.9f\n", QUANTILES[q], s.frameQuantiles[q]);
+    appendMetric(buffer, length, "game_frame_seconds_max", "gauge", "Slowest frame in the quantile window.", s.frameMax);
+    appendMetric(buffer, length, "game_zombies", "gauge", "Live zombies.", s.gauges.zombies);
+    appendMetric(buffer, length, "game_food", "gauge", "Food items on the ground.", s.gauges.food);
+    appendMetric(buffer, length, "game_wave", "gauge", "Current wave.", s.gauges.wave);
+    appendMetric(buffer, length, "game_pending_spawns", "gauge", "Zombies queued by the wave director.", s.gauges.pendingSpawns);
+    appendMetric(buffer, length, "game_playing", "gauge", "1 while the simulation is running.", s.gauges.playing ? 1.0 : 0.0);
+    appendMetric(buffer, length, "game_draw_calls", "gauge", "World draw calls in the last frame.", s.gauges.drawCalls);
+    appendMetric(buffer, length, "game_texture_bytes", "gauge", "Texture memory at the last memory report.", static_cast<double>(s.gauges.textureBytes));
+    appendMetric(buffer, length, "game_tracked_memory_bytes", "gauge", "Memory in all categories at the last memory report.", static_cast<double>(s.gauges.trackedBytes));
+    append(buffer, length, "# HELP game_save_seconds Time spent writing save games.\n# TYPE game_save_seconds summary\n");
+    append(buffer, length, "game_save_seconds_sum %.9f\ngame_save_seconds_count %llu\n", s.saveSeconds, static_cast<unsigned long long>(s.saves));
+    appendMetric(buffer, length, "game_last_save_seconds", "gauge", "Time the last save took.", s.lastSaveSeconds);
+    return length;
+}
+
+// Writes all of a buffer to a client; a client that hangs up just ends the answer
+static void sendAll(int fd, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(fd, data, length, MSG_NOSIGNAL); // No SIGPIPE when the scraper is gone
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return;
+        data += sent;
+        length -= static_cast<size_t>(sent);
+    }
+}
+
+// Server thread: answers each connection with the latest snapshot
+static void serve() {
+    static char body[RESPONSE_BYTES];
+    static char header[256];
+    while (!stopping.load()) {
+        pollfd listening = {listenFd, POLLIN, 0};
+        if (poll(&listening, 1, ACCEPT_POLL_MS) <= 0) continue;
+        int client = accept(listenFd, nullptr, nullptr);
+        if (client < 0) continue;
+        // An HTTP scraper sends a request line first; a plain client only reads
+        bool http = false;
+        pollfd request = {client, POLLIN, 0};
+        if (poll(&request, 1, REQUEST_WAIT_MS) > 0) {
+            char line[1024];
+            ssize_t received = recv(client, line, sizeof(line), 0);
+            http = received >= 4 && std::memcmp(line, "GET ", 4) == 0;
+        }
+        size_t length = formatMetrics(latest(), body);
+        if (http) {
+            int headerLength = std::snprintf(header, sizeof(header),
+                "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n", length);
+            sendAll(client, header, static_cast<size_t>(headerLength));
+        }
+        sendAll(client, body, length);
+        close(client);
+    }
+}
+
+// Opens the socket and starts the server thread
+bool metricsStart(const char* path) {
+    if (running) return true;
+    if (std::strlen(path) >= sizeof(address.sun_path)) {
+        std::cerr << "Metrics: socket path too long: " << path << "\n";
+        return false;
+    }
+    struct stat existing;
+    if (lstat(path, &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            std::cerr << "Metrics: " << path << " exists and is not a socket\n";
+            return false;
+        }
+        unlink(path); // Left behind by a previous run
+    }
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        std::cerr << "Metrics: cannot create a socket: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, path);
+    if (bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listenFd, 8) != 0) {
+        std::cerr << "Metrics: cannot listen on " << path << ": " << std::strerror(errno) << "\n";
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    lastRefresh = std::chrono::steady_clock::now();
+    publish(); // Scrapes before the first game see zeros rather than nothing
+    stopping.store(false);
+    server = std::thread(serve);
+    running = true;
+    std::cout << "Metrics: serving on " << path << "\n";
+    return true;
+}
+
+// Stops the server thread
+void metricsStop() {
+    if (!running) return;
+    stopping.store(true);
+    server.join();
+    close(listenFd);
+    listenFd = -1;
+    unlink(address.sun_path);
+    running = false;
+}
+
+// Whether the server is running
+bool metricsRunning() {
+    return running;
+}
+
+// Starts a game
+void metricsStartGame() {
+    frameStarted = false;
+}
+
+// Recomputes the frame-time quantiles and the rates
+static void refresh() {
+    std::copy(frameTimes, frameTimes + frameTimeCount, sortedTimes);
+    std::sort(sortedTimes, sortedTimes + frameTimeCount);
+    for (int q = 0; q < 3; q++) {
+        current.frameQuantiles[q] = frameTimeCount ? sortedTimes[static_cast<int>(QUANTILES[q] * (frameTimeCount - 1))] : 0.0;
+    }
+    current.frameMax = frameTimeCount ? sortedTimes[frameTimeCount - 1] : 0.0;
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - lastRefresh).count();
+    if (seconds > 0.0) {
+        current.frameRate = (current.frames - refreshFrames) / seconds;
+        current.tickRate = (current.ticks - refreshTicks) / seconds;
+    }
+    lastRefresh = now;
+    refreshFrames = current.frames;
+    refreshTicks = current.ticks;
+    framesSinceRefresh = 0;
+}
+
+// Ends a frame and publishes a snapshot
+void metricsEndFrame(const MetricsGauges& gauges) {
+    if (!running) return;
+    auto now = std::chrono::steady_clock::now();
+    if (frameStarted) {
+        frameTimes[frameTimeNext] = std::chrono::duration<float>(now - lastFrameEnd).count();
+        frameTimeNext = (frameTimeNext + 1) % FRAME_WINDOW;
+        frameTimeCount = std::min(frameTimeCount + 1, FRAME_WINDOW);
+    }
+    lastFrameEnd = now;
+    frameStarted = true;
+    current.frames++;
+    if (gauges.playing) current.ticks++;
+    current.gauges = gauges;
+    if (++framesSinceRefresh >= QUANTILE_FRAMES) refresh();
+    publish();
+}
+
+// Records a save
+void metricsRecordSave(double seconds) {
+    current.saves++;
+    current.saveSeconds += seconds;
+    current.lastSaveSeconds = seconds;
+}
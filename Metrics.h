@@ -0,0 +1,44 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <cstdint>
+
+// Local metrics endpoint (--metrics-socket=<path>). A background thread listens on a Unix domain socket and answers
+// every connection with the current counters and gauges in the Prometheus text format; scrapers that send an HTTP
+// GET get an HTTP response, plain "connect and read" clients get the text alone. The game thread only fills a
+// snapshot at the end of each frame and hands it over through a lock-free triple buffer, so a scrape never blocks
+// the game loop and the game loop never waits on a scrape. The server thread formats into a fixed buffer: it
+// allocates nothing and touches no game state
+
+// Gauges the game reports with each frame
+struct MetricsGauges {
+    bool playing; // Whether the frame ran a simulation tick (not paused, not on an end screen)
+    int zombies; // Live zombies
+    int food; // Food items on the ground
+    int wave; // Current wave
+    int pendingSpawns; // Zombies queued by the wave director
+    int drawCalls; // World draw calls this frame (background, terrain, platform tiles, sprites, health bars)
+    uint64_t textureBytes; // Texture memory from the last memory report
+    uint64_t trackedBytes; // All memory from the last memory report
+};
+
+// Opens the socket at path (replacing a stale socket file) and starts the server thread. Returns false (and logs)
+// if the path is too long, taken by something else, or the socket cannot be set up
+bool metricsStart(const char* path);
+
+// Stops the server thread and removes the socket file
+void metricsStop();
+
+// Whether the server is running
+bool metricsRunning();
+
+// Starts a game: the time spent in menus is not counted as a frame
+void metricsStartGame();
+
+// Ends a frame: records its time and publishes a new snapshot (frame-time quantiles are refreshed once a second)
+void metricsEndFrame(const MetricsGauges& gauges);
+
+// Records how long a save took
+void metricsRecordSave(double seconds);
+
+#endif
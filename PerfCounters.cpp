@@ -0,0 +1,208 @@
+#include "PerfCounters.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <string>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+// Counter state, owned by the game thread: PerfScope switches phases nowhere else, and the metrics server never reads it
+static bool enabled = false; // Whether phases are being accounted (perfOpen)
+static bool timePhases = false; // Whether phases are timed without perfOpen
+static int eventFds[PERF_EVENT_COUNT] = {-1, -1, -1, -1}; // Counter descriptors, -1 when unavailable
+static int eventSlot[PERF_EVENT_COUNT] = {-1, -1, -1, -1}; // Position of each event in a group read
+static int groupLeader = -1; // First counter opened; reading it returns the whole group
+static int openCount = 0; // Counters in the group
+static std::string unavailableReason; // Why counters are missing, for the report
+static PerfPhase current = PERF_OTHER; // Phase being charged
+static uint64_t lastCounts[PERF_EVENT_COUNT]; // Counter values at the last phase switch
+static std::chrono::steady_clock::time_point lastTime; // Time of the last phase switch
+static uint64_t phaseCounts[PERF_PHASE_COUNT][PERF_EVENT_COUNT]; // Events charged to each phase
+static double phaseSeconds[PERF_PHASE_COUNT]; // Time charged to each phase
+static double frameSeconds[PERF_PHASE_COUNT]; // Time charged to each phase in the frame in progress
+static double lastFrameSeconds[PERF_PHASE_COUNT]; // Time each phase took in the last completed frame
+static uint64_t frames = 0; // Frames counted since the last reset
+
+// Phase and event names, in enum order
+static const char* const PHASE_NAMES[PERF_PHASE_COUNT] = {
+    "other", "collision", "ai", "zombie update", "terrain refresh", "food", "render prep", "present + wait", "publish"};
+static const char* const EVENT_NAMES[PERF_EVENT_COUNT] = {"cycles", "instructions", "cache misses", "branch misses"};
+
+// Reads every open counter (one read of the group leader); unavailable events read as 0
+static void readCounts(uint64_t counts[PERF_EVENT_COUNT]) {
+    uint64_t buffer[1 + PERF_EVENT_COUNT] = {}; // PERF_FORMAT_GROUP layout: count, then one value per counter
+    if (groupLeader >= 0 && read(groupLeader, buffer, sizeof(buffer)) < static_cast<ssize_t>(sizeof(uint64_t))) buffer[0] = 0;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        counts[e] = eventSlot[e] >= 0 && static_cast<uint64_t>(eventSlot[e]) < buffer[0] ? buffer[1 + eventSlot[e]] : 0;
+    }
+}
+
+// Charges everything since the last switch to the current phase and makes phase current
+static void switchPhase(PerfPhase phase) {
+    if (enabled) {
+        uint64_t counts[PERF_EVENT_COUNT];
+        readCounts(counts);
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) phaseCounts[current][e] += counts[e] - lastCounts[e];
+        std::memcpy(lastCounts, counts, sizeof(lastCounts));
+    }
+    if (enabled || timePhases) {
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - lastTime).count();
+        phaseSeconds[current] += seconds;
+        frameSeconds[current] += seconds;
+        lastTime = now;
+    }
+    current = phase;
+}
+
+#ifdef __linux__
+// Opens one user-space hardware counter of the calling thread, in the group when there is one
+static int openEvent(uint64_t config, int group) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1; // Allowed at perf_event_paranoid 2, and kernel time is not ours to tune
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, group, 0));
+}
+#endif
+
+// Turns phase accounting on and opens the counters the kernel allows
+bool perfOpen() {
+    perfClose();
+#ifdef __linux__
+    const uint64_t CONFIGS[PERF_EVENT_COUNT] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+    int firstError = 0;
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        int fd = openEvent(CONFIGS[e], groupLeader);
+        if (fd < 0) {
+            if (!firstError) firstError = errno;
+            continue;
+        }
+        eventFds[e] = fd;
+        eventSlot[e] = openCount++;
+        if (groupLeader < 0) groupLeader = fd;
+    }
+    if (firstError) {
+        unavailableReason = std::strerror(firstError);
+        if (firstError == EACCES || firstError == EPERM) unavailableReason += " (lower /proc/sys/kernel/perf_event_paranoid to 2 or less)";
+        else if (firstError == ENOENT || firstError == EOPNOTSUPP) unavailableReason += " (no such counter on this CPU or hypervisor)";
+    }
+#else
+    unavailableReason = "perf_event_open is Linux only";
+#endif
+    enabled = true;
+    perfReset();
+    return openCount > 0;
+}
+
+// Closes the counters
+void perfClose() {
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (eventFds[e] >= 0) close(eventFds[e]);
+        eventFds[e] = -1;
+        eventSlot[e] = -1;
+    }
+    groupLeader = -1;
+    openCount = 0;
+    unavailableReason.clear();
+    enabled = false;
+}
+
+// Whether phase accounting is on
+bool perfEnabled() {
+    return enabled;
+}
+
+// Times phases without counters
+void perfTimePhases(bool on) {
+    if (on && !timePhases && !enabled) lastTime = std::chrono::steady_clock::now(); // Nothing was timed until now
+    timePhases = on;
+}
+
+// Whether an event is being counted
+bool perfEventAvailable(PerfEvent event) {
+    return eventFds[event] >= 0;
+}
+
+// Clears the totals
+void perfReset() {
+    std::memset(phaseCounts, 0, sizeof(phaseCounts));
+    std::memset(phaseSeconds, 0, sizeof(phaseSeconds));
+    std::memset(frameSeconds, 0, sizeof(frameSeconds));
+    std::memset(lastFrameSeconds, 0, sizeof(lastFrameSeconds));
+    frames = 0;
+    readCounts(lastCounts);
+    lastTime = std::chrono::steady_clock::now();
+}
+
+// Ends a frame
+void perfEndFrame() {
+    if (!enabled && !timePhases) return;
+    switchPhase(current); // Charge the time up to now to this frame
+    std::memcpy(lastFrameSeconds, frameSeconds, sizeof(frameSeconds));
+    std::memset(frameSeconds, 0, sizeof(frameSeconds));
+    frames++;
+}
+
+// Seconds a phase took in the last completed frame
+double perfLastFrameSeconds(PerfPhase phase) {
+    return lastFrameSeconds[phase];
+}
+
+// Name of a phase
+const char* perfPhaseName(PerfPhase phase) {
+    return PHASE_NAMES[phase];
+}
+
+// Writes per-phase averages
+void perfReport(std::ostream& out) {
+    if (!enabled) return;
+    switchPhase(current); // Charge the time up to now
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    double perFrame = frames ? 1.0 / frames : 0.0;
+    out << "Frame phases over " << frames << " frames (per-frame averages):\n";
+    for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+        if (eventFds[e] < 0) out << "  " << EVENT_NAMES[e] << ": not counted, " << unavailableReason << "\n";
+    }
+    out << "  " << std::left << std::setw(16) << "phase" << std::right << std::setw(9) << "ms" << std::setw(14) << "cycles"
+        << std::setw(14) << "instructions" << std::setw(7) << "IPC" << std::setw(14) << "cache misses"
+        << std::setw(14) << "branch misses" << "\n";
+    out << std::fixed;
+    for (int p = 0; p < PERF_PHASE_COUNT; p++) {
+        const uint64_t* counts = phaseCounts[p];
+        out << "  " << std::left << std::setw(16) << PHASE_NAMES[p] << std::right << std::setprecision(3)
+            << std::setw(9) << phaseSeconds[p] * 1000.0 * perFrame << std::setprecision(0);
+        for (int e = 0; e < PERF_EVENT_COUNT; e++) {
+            if (e == PERF_CACHE_MISSES) { // IPC goes between instructions and the misses
+                bool ipc = perfEventAvailable(PERF_CYCLES) && perfEventAvailable(PERF_INSTRUCTIONS) && counts[PERF_CYCLES] > 0;
+                if (ipc) out << std::setprecision(2) << std::setw(7) << static_cast<double>(counts[PERF_INSTRUCTIONS]) / counts[PERF_CYCLES] << std::setprecision(0);
+                else out << std::setw(7) << "n/a";
+            }
+            if (perfEventAvailable(static_cast<PerfEvent>(e))) out << std::setw(14) << counts[e] * perFrame;
+            else out << std::setw(14) << "n/a";
+        }
+        out << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+// Switches to a phase
+PerfScope::PerfScope(PerfPhase phase) : previous(current) {
+    switchPhase(phase);
+}
+
+// Switches back to the enclosing phase
+PerfScope::~PerfScope() {
+    switchPhase(previous);
+}
@@ -0,0 +1,77 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <cstdint>
+#include <ostream>
+
+// Hardware performance counters per frame phase (--perf-counters). CPU cycles, instructions, cache misses and
+// branch misses of the game thread are read through perf_event_open each time the phase changes, and the
+// difference is charged to the phase that just ended. Where the kernel does not allow the counters
+// (perf_event_paranoid, containers, virtual machines) the phases are still timed, and the report says why
+// the counters are missing. Phases can also be timed on their own (no counters, no system calls) for the frame trace
+
+// Frame phases, set with PerfScope
+enum PerfPhase {
+    PERF_OTHER, // Anything outside a scope (events, input, waves, spawning)
+    PERF_COLLISION, // Moving platforms and the player's terrain collision
+    PERF_AI, // Spatial sort, senses, squads and behavior trees
+    PERF_ZOMBIES, // Zombie updates, including their terrain collision, hits and drops
+    PERF_TERRAIN, // Destruction follow-up: caches, jump tables, waking food
+    PERF_FOOD, // Food updates
+    PERF_RENDER, // Render preparation: draw calls and HUD text up to the present
+    PERF_PRESENT, // SDL_RenderPresent and frame pacing (GPU and vsync waits, the frame cap delay)
+    PERF_PUBLISH, // Metrics snapshot, memory gauges and shared state, after the frame is on screen
+    PERF_PHASE_COUNT
+};
+
+// Hardware events, in report order
+enum PerfEvent {
+    PERF_CYCLES, // CPU cycles
+    PERF_INSTRUCTIONS, // Instructions retired
+    PERF_CACHE_MISSES, // Last-level cache misses
+    PERF_BRANCH_MISSES, // Mispredicted branches
+    PERF_EVENT_COUNT
+};
+
+// Turns phase accounting on and opens whichever counters the kernel allows. Returns whether any counter opened;
+// phases are timed either way
+bool perfOpen();
+
+// Closes the counters and turns phase accounting off
+void perfClose();
+
+// Whether phase accounting is on, and whether an event is being counted
+bool perfEnabled();
+bool perfEventAvailable(PerfEvent event);
+
+// Times phases with the steady clock even without perfOpen (two clock reads per phase change)
+void perfTimePhases(bool on);
+
+// Clears the totals (at the start of a game)
+void perfReset();
+
+// Ends a frame: charges the time up to now, keeps the frame's phase times and counts it for per-frame averages
+void perfEndFrame();
+
+// Seconds a phase took in the last completed frame (0 while phases are not timed)
+double perfLastFrameSeconds(PerfPhase phase);
+
+// Name of a phase for reports and traces
+const char* perfPhaseName(PerfPhase phase);
+
+// Writes per-phase averages: time, cycles, instructions, IPC, cache and branch misses per frame
+void perfReport(std::ostream& out);
+
+// Charges counts to a phase during its lifetime. Scopes nest: the innermost one is charged
+class PerfScope {
+public:
+    explicit PerfScope(PerfPhase phase);
+    ~PerfScope();
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+private:
+    PerfPhase previous; // Phase to switch back to
+};
+
+#endif
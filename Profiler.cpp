@@ -0,0 +1,171 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <sys/time.h>
+#include <unordered_map>
+
+static const int MAX_DEPTH = 32; // Frames kept per sample, innermost first (the outermost ones are cut off)
+static const int SKIPPED_FRAMES = 2; // The signal handler and the kernel's signal trampoline
+
+// One captured call stack
+struct ProfileSample {
+    int depth; // Frames captured, including the skipped ones
+    void* frames[MAX_DEPTH]; // Return addresses, innermost first
+};
+
+// Profiler state. The handler only touches the ring and the counter, both set up before the timer starts
+static ProfileSample* ring = nullptr; // Sample ring, allocated by profilerStart
+static size_t ringCapacity = 0; // Samples the ring holds
+static std::atomic<size_t> samplesTaken{0}; // Samples since start; the next one goes to samplesTaken % ringCapacity
+static std::atomic<bool> sampling{false}; // Whether the timer is armed
+static struct sigaction previousAction; // SIGPROF handler to restore on stop
+static_assert(std::atomic<size_t>::is_always_lock_free, "The sample counter must be lock-free to use it in a signal handler");
+
+// SIGPROF handler: claims the next ring slot and walks the stack into it. Allocates nothing and takes no locks
+// (backtrace was called once before the timer started, so its unwinder is already loaded)
+static void onProfileSignal(int) {
+    int savedErrno = errno; // The interrupted code may be about to read errno
+    if (sampling.load(std::memory_order_relaxed)) {
+        size_t index = samplesTaken.fetch_add(1, std::memory_order_relaxed) % ringCapacity;
+        ring[index].depth = backtrace(ring[index].frames, MAX_DEPTH);
+    }
+    errno = savedErrno;
+}
+
+// Starts sampling
+bool profilerStart(int hz, size_t capacity) {
+    if (sampling.load() || hz <= 0 || capacity == 0) {
+        std::cerr << "Profiler: already running or bad settings (" << hz << " Hz, " << capacity << " samples)\n";
+        return false;
+    }
+    delete[] ring;
+    ring = new ProfileSample[capacity]();
+    ringCapacity = capacity;
+    samplesTaken.store(0);
+    void* warmUp[1];
+    backtrace(warmUp, 1); // First call loads the unwinder, which must not happen inside the handler
+
+    struct sigaction action = {};
+    action.sa_handler = onProfileSignal;
+    action.sa_flags = SA_RESTART; // Interrupted system calls carry on instead of failing with EINTR
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, &previousAction) != 0) {
+        std::cerr << "Profiler: cannot install the SIGPROF handler\n";
+        return false;
+    }
+    sampling.store(true);
+    struct itimerval timer = {};
+    timer.it_interval.tv_usec = hz >= 1000000 ? 1 : 1000000 / hz;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        std::cerr << "Profiler: cannot start the profiling timer\n";
+        sampling.store(false);
+        sigaction(SIGPROF, &previousAction, nullptr);
+        return false;
+    }
+    return true;
+}
+
+// Stops the timer
+void profilerStop() {
+    if (!sampling.load()) return;
+    struct itimerval off = {};
+    setitimer(ITIMER_PROF, &off, nullptr);
+    sampling.store(false);
+    sigaction(SIGPROF, &previousAction, nullptr);
+}
+
+// Whether the timer is running
+bool profilerRunning() {
+    return sampling.load();
+}
+
+// Samples taken since start
+size_t profilerSampleCount() {
+    return samplesTaken.load();
+}
+
+// Samples lost to the ring wrapping around
+size_t profilerOverwrittenCount() {
+    size_t taken = samplesTaken.load();
+    return taken > ringCapacity ? taken - ringCapacity : 0;
+}
+
+// Function name of an address without its parameter list, or module+offset when the symbol is not exported
+static std::string symbolName(void* address) {
+    Dl_info info;
+    if (!dladdr(address, &info)) {
+        char hex[32];
+        std::snprintf(hex, sizeof(hex), "%p", address);
+        return hex;
+    }
+    if (!info.dli_sname) {
+        std::string module = info.dli_fname ? info.dli_fname : "?";
+        module = module.substr(module.find_last_of('/') + 1);
+        char offset[32];
+        std::snprintf(offset, sizeof(offset), "+0x%zx", static_cast<size_t>(static_cast<char*>(address) - static_cast<char*>(info.dli_fbase)));
+        return module + offset;
+    }
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+    std::string name = status == 0 && demangled ? demangled : info.dli_sname;
+    std::free(demangled);
+    // Drop a trailing " const" and the parameter list: flame graphs merge overloads, which keeps the frames short
+    if (name.size() > 6 && name.compare(name.size() - 6, 6, " const") == 0) name.resize(name.size() - 6);
+    if (!name.empty() && name.back() == ')') {
+        int depth = 0;
+        for (size_t i = name.size(); i-- > 0; ) {
+            if (name[i] == ')') depth++;
+            else if (name[i] == '(' && --depth == 0) {
+                name.resize(i);
+                break;
+            }
+        }
+    }
+    for (char& c : name) {
+        if (c == ';') c = ':'; // ';' separates frames in the folded format
+    }
+    return name;
+}
+
+// Stops sampling and writes folded stacks
+bool profilerWrite(const char* path) {
+    profilerStop();
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Profiler: cannot write " << path << "\n";
+        return false;
+    }
+    std::unordered_map<void*, std::string> names; // Symbol cache: stacks share most of their frames
+    std::map<std::string, size_t> stacks; // Folded stack and how often it was sampled
+    size_t kept = std::min(samplesTaken.load(), ringCapacity);
+    for (size_t i = 0; i < kept; i++) {
+        const ProfileSample& sample = ring[i];
+        if (sample.depth <= SKIPPED_FRAMES) continue; // Nothing below the handler
+        std::string folded;
+        for (int f = sample.depth - 1; f >= SKIPPED_FRAMES; f--) {
+            // Outer frames are return addresses; step back into the call instruction so it resolves to the caller
+            void* address = static_cast<char*>(sample.frames[f]) - (f > SKIPPED_FRAMES ? 1 : 0);
+            auto cached = names.find(address);
+            if (cached == names.end()) cached = names.emplace(address, symbolName(address)).first;
+            if (!folded.empty()) folded += ';';
+            folded += cached->second;
+        }
+        stacks[folded]++;
+    }
+    for (const auto& [stack, count] : stacks) out << stack << " " << count << "\n";
+    std::cout << "Profile: " << kept << " samples (" << profilerOverwrittenCount() << " older ones overwritten), "
+              << stacks.size() << " distinct stacks written to " << path << "\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,31 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstddef>
+
+// In-process sampling profiler for machines where perf cannot be attached. A SIGPROF interval timer interrupts the
+// process hz times per second of CPU time; the handler copies the call stack into a ring buffer allocated up front
+// and returns, so the cost is bounded by hz x one stack walk and memory never grows. The ring keeps the most recent
+// samples, which makes it safe to leave running in field builds. Samples are symbolized only when written out, as
+// folded stacks ("main;RunMainGame;updateZombieGroup 42") ready for flamegraph.pl or speedscope.
+// Function names need the executable linked with -rdynamic; other frames are written as module+offset
+
+// Starts sampling hz times per CPU second into a ring of capacity samples. Returns false (and logs) if the
+// profiler is already running or the timer cannot be set up
+bool profilerStart(int hz, size_t capacity);
+
+// Stops the timer; samples stay in the ring until written
+void profilerStop();
+
+// Whether the timer is running
+bool profilerRunning();
+
+// Samples taken since start, and how many of them were overwritten because the ring was full
+size_t profilerSampleCount();
+size_t profilerOverwrittenCount();
+
+// Stops sampling and writes the samples in the ring as folded stacks, one line per distinct stack with its count.
+// Returns false (and logs) if the file cannot be written
+bool profilerWrite(const char* path);
+
+#endif
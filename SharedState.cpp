@@ -0,0 +1,188 @@
+#include "SharedState.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <sched.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Game side state
+static SharedStateHeader* segment = nullptr; // Mapped segment, nullptr when closed
+static size_t segmentBytes = 0; // Mapping size
+static std::string segmentName; // Shared memory object name, with its leading '/'
+
+// Object name with the leading '/' shm_open wants
+static std::string objectName(const char* name) {
+    return name[0] == '/' ? name : std::string("/") + name;
+}
+
+// Record arrays of a segment
+static SharedEntity* records(const SharedStateHeader* header, uint32_t offset) {
+    return reinterpret_cast<SharedEntity*>(reinterpret_cast<char*>(const_cast<SharedStateHeader*>(header)) + offset);
+}
+
+// Creates and maps the segment
+bool sharedStateOpen(const char* name, uint32_t zombieCapacity, uint32_t foodCapacity) {
+    sharedStateClose();
+    std::string object = objectName(name);
+    uint32_t zombieOffset = static_cast<uint32_t>((sizeof(SharedStateHeader) + 63) & ~size_t(63)); // Records start on a cache line
+    uint32_t foodOffset = zombieOffset + zombieCapacity * static_cast<uint32_t>(sizeof(SharedEntity));
+    size_t bytes = foodOffset + foodCapacity * sizeof(SharedEntity);
+    // A fresh object rather than a truncated one: a reader still mapping an old segment would fault on the shrunk pages
+    shm_unlink(object.c_str());
+    int fd = shm_open(object.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        std::cerr << "Shared state: cannot create " << object << ": " << std::strerror(errno) << "\n";
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        std::cerr << "Shared state: cannot size " << object << ": " << std::strerror(errno) << "\n";
+        close(fd);
+        shm_unlink(object.c_str());
+        return false;
+    }
+    void* mapping = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the object alive
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Shared state: cannot map " << object << ": " << std::strerror(errno) << "\n";
+        shm_unlink(object.c_str());
+        return false;
+    }
+    segment = static_cast<SharedStateHeader*>(mapping); // Zero-filled by ftruncate
+    segment->headerBytes = sizeof(SharedStateHeader);
+    segment->entityBytes = sizeof(SharedEntity);
+    segment->zombieCapacity = zombieCapacity;
+    segment->foodCapacity = foodCapacity;
+    segment->zombieOffset = zombieOffset;
+    segment->foodOffset = foodOffset;
+    segment->frame.screen = SHARED_MENU;
+    segment->version = SHARED_STATE_VERSION;
+    std::atomic_thread_fence(std::memory_order_release);
+    segment->magic = SHARED_STATE_MAGIC; // Last: a reader that sees it sees the whole layout
+    segmentBytes = bytes;
+    segmentName = object;
+    std::cout << "Shared state: " << object << ", " << bytes << " bytes (" << zombieCapacity << " zombies, " << foodCapacity << " food)\n";
+    return true;
+}
+
+// Unmaps and removes the segment
+void sharedStateClose() {
+    if (!segment) return;
+    munmap(segment, segmentBytes);
+    shm_unlink(segmentName.c_str()); // Readers that still have it mapped keep their copy until they unmap
+    segment = nullptr;
+    segmentBytes = 0;
+}
+
+// Whether a segment is open
+bool sharedStateEnabled() {
+    return segment != nullptr;
+}
+
+// Starts a frame
+SharedFrame* sharedStateBeginWrite() {
+    if (!segment) return nullptr;
+    segment->sequence.store(segment->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release); // The odd sequence is visible before any frame write
+    return &segment->frame;
+}
+
+// Zombie records
+SharedEntity* sharedStateZombies() {
+    return segment ? records(segment, segment->zombieOffset) : nullptr;
+}
+
+// Food records
+SharedEntity* sharedStateFood() {
+    return segment ? records(segment, segment->foodOffset) : nullptr;
+}
+
+// Zombie record capacity
+uint32_t sharedStateZombieCapacity() {
+    return segment ? segment->zombieCapacity : 0;
+}
+
+// Food record capacity
+uint32_t sharedStateFoodCapacity() {
+    return segment ? segment->foodCapacity : 0;
+}
+
+// Publishes the frame
+void sharedStateEndWrite() {
+    if (!segment) return;
+    segment->sequence.store(segment->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Maps a segment for reading
+const SharedStateHeader* sharedStateMap(const char* name) {
+    std::string object = objectName(name);
+    int fd = shm_open(object.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        std::cerr << "Shared state: cannot open " << object << ": " << std::strerror(errno) << "\n";
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SharedStateHeader)) {
+        std::cerr << "Shared state: " << object << " is too small\n";
+        close(fd);
+        return nullptr;
+    }
+    size_t bytes = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        std::cerr << "Shared state: cannot map " << object << ": " << std::strerror(errno) << "\n";
+        return nullptr;
+    }
+    const SharedStateHeader* header = static_cast<const SharedStateHeader*>(mapping);
+    bool valid = header->magic == SHARED_STATE_MAGIC;
+    std::atomic_thread_fence(std::memory_order_acquire); // Pairs with the fence before magic is written
+    valid = valid && header->version == SHARED_STATE_VERSION && header->headerBytes == sizeof(SharedStateHeader) &&
+            header->entityBytes == sizeof(SharedEntity) &&
+            header->zombieOffset + static_cast<size_t>(header->zombieCapacity) * sizeof(SharedEntity) <= bytes &&
+            header->foodOffset + static_cast<size_t>(header->foodCapacity) * sizeof(SharedEntity) <= bytes;
+    if (!valid) {
+        std::cerr << "Shared state: " << object << " has an unknown layout (not written by this version of the game)\n";
+        munmap(mapping, bytes);
+        return nullptr;
+    }
+    return header;
+}
+
+// Unmaps a reader mapping
+void sharedStateUnmap(const SharedStateHeader* header) {
+    if (!header) return;
+    size_t bytes = header->foodOffset + static_cast<size_t>(header->foodCapacity) * sizeof(SharedEntity);
+    munmap(const_cast<SharedStateHeader*>(header), bytes);
+}
+
+// Copies a consistent frame
+bool sharedStateRead(const SharedStateHeader* header, SharedFrame& frame, std::vector<SharedEntity>& zombies,
+                     std::vector<SharedEntity>& food, int maxAttempts) {
+    zombies.resize(header->zombieCapacity); // Sized up front so no allocation happens between the sequence reads
+    food.resize(header->foodCapacity);
+    for (int attempt = 0; attempt < maxAttempts; attempt++) {
+        uint64_t before = header->sequence.load(std::memory_order_acquire);
+        if (before & 1) { // The game is writing; it takes microseconds
+            sched_yield();
+            continue;
+        }
+        std::memcpy(&frame, &header->frame, sizeof(frame));
+        // Counts may be torn on a lost race; clamp them so the copies stay in bounds, the sequence check rejects them
+        uint32_t zombieCount = std::min(frame.zombieCount, header->zombieCapacity);
+        uint32_t foodCount = std::min(frame.foodCount, header->foodCapacity);
+        std::memcpy(zombies.data(), records(header, header->zombieOffset), zombieCount * sizeof(SharedEntity));
+        std::memcpy(food.data(), records(header, header->foodOffset), foodCount * sizeof(SharedEntity));
+        std::atomic_thread_fence(std::memory_order_acquire); // The copies complete before the sequence is read again
+        if (header->sequence.load(std::memory_order_relaxed) == before) {
+            zombies.resize(zombieCount);
+            food.resize(foodCount);
+            return true;
+        }
+    }
+    return false;
+}
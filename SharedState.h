@@ -0,0 +1,100 @@
+#ifndef SHAREDSTATE_H
+#define SHAREDSTATE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Live world state in POSIX shared memory (--shared-state=<name>) for overlays, dashboards and bot controllers.
+// The game maps the segment once and writes the frame straight into it at the end of every frame: no system
+// calls, no intermediate buffer. A seqlock guards the frame: the sequence number is odd while the game writes and
+// goes up by two per frame, so a reader copies the frame and keeps it only if the sequence was even and unchanged
+// around the copy. Readers never block the game; a reader that loses the race simply copies again.
+//
+// Segment layout (version 1), native byte order:
+//   SharedStateHeader at offset 0
+//   zombieCapacity SharedEntity records at zombieOffset
+//   foodCapacity SharedEntity records at foodOffset
+// A reader checks magic, version and entityBytes before trusting the offsets
+
+static const uint32_t SHARED_STATE_MAGIC = 0x53344754; // "TG4S"
+static const uint32_t SHARED_STATE_VERSION = 1; // Bumped whenever the layout changes
+
+// Game screens, as published in SharedFrame::screen
+enum SharedScreen { SHARED_PLAYING, SHARED_PAUSED, SHARED_GAME_OVER, SHARED_VICTORY, SHARED_MENU };
+
+// One player, zombie or food item
+struct SharedEntity {
+    float x, y; // Top-left position in pixels
+    float vx, vy; // Velocity in pixels per tick
+    int32_t health; // Health (0 for food)
+    int32_t kind; // Archetype ID for zombies, 0 otherwise
+    uint32_t id; // Stable handle for zombies, list index for food
+    uint32_t reserved; // Zero
+};
+
+// Everything that changes per frame, copied as a whole by readers
+struct SharedFrame {
+    uint64_t frame; // Frames since the game started
+    double time; // Seconds since the game started
+    int32_t screen; // SharedScreen
+    int32_t score; // Current score
+    int32_t wave; // Current wave
+    int32_t pendingSpawns; // Zombies queued by the wave director
+    uint32_t zombieCount; // Valid zombie records (at most zombieCapacity)
+    uint32_t foodCount; // Valid food records (at most foodCapacity)
+    uint32_t zombiesDropped; // Live zombies that did not fit in the segment
+    uint32_t reserved; // Zero
+    SharedEntity player; // The player
+};
+
+// Start of the segment
+struct SharedStateHeader {
+    uint32_t magic; // SHARED_STATE_MAGIC
+    uint32_t version; // SHARED_STATE_VERSION
+    uint32_t headerBytes; // sizeof(SharedStateHeader)
+    uint32_t entityBytes; // sizeof(SharedEntity)
+    uint32_t zombieCapacity; // Zombie records in the segment
+    uint32_t foodCapacity; // Food records in the segment
+    uint32_t zombieOffset; // Byte offset of the zombie records
+    uint32_t foodOffset; // Byte offset of the food records
+    std::atomic<uint64_t> sequence; // Seqlock: odd while the game writes
+    SharedFrame frame; // Frame data, valid while sequence is even and unchanged
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The sequence number must be lock-free to share it between processes");
+
+// Game side: creates the segment /name and maps it, replacing any earlier object of that name (readers of the old
+// one keep their mapping). Returns false (and logs) on failure
+bool sharedStateOpen(const char* name, uint32_t zombieCapacity, uint32_t foodCapacity);
+
+// Game side: unmaps and removes the segment
+void sharedStateClose();
+
+// Game side: whether a segment is open
+bool sharedStateEnabled();
+
+// Game side: starts a frame (sequence goes odd) and returns the frame to fill, or nullptr when no segment is open
+SharedFrame* sharedStateBeginWrite();
+
+// Game side: record arrays to fill between begin and end, and their capacities
+SharedEntity* sharedStateZombies();
+SharedEntity* sharedStateFood();
+uint32_t sharedStateZombieCapacity();
+uint32_t sharedStateFoodCapacity();
+
+// Game side: publishes the frame (sequence goes even)
+void sharedStateEndWrite();
+
+// Reader side: maps the segment /name read-only and checks its layout. Returns nullptr (and logs) on failure
+const SharedStateHeader* sharedStateMap(const char* name);
+
+// Reader side: unmaps a segment mapped by sharedStateMap
+void sharedStateUnmap(const SharedStateHeader* header);
+
+// Reader side: copies a consistent frame and its records. Returns false if the game kept writing through
+// maxAttempts tries (it writes once a frame, so a handful is plenty)
+bool sharedStateRead(const SharedStateHeader* header, SharedFrame& frame, std::vector<SharedEntity>& zombies,
+                     std::vector<SharedEntity>& food, int maxAttempts = 16);
+
+#endif
@@ -0,0 +1,46 @@
+#include "SpatialSort.h"
+
+// Splits entries into kept and moved, radix sorts the moved ones and merges both runs
+const std::vector<uint32_t>& SpatialSorter::sort(std::span<const uint32_t> keys, std::span<const uint32_t> lastKeys) {
+    kept.clear();
+    moved.clear();
+    order.clear();
+    uint32_t floor = 0; // Largest kept key so far
+    for (uint32_t i = 0; i < keys.size(); i++) {
+        if (keys[i] == lastKeys[i] && keys[i] >= floor) {
+            kept.push_back(i);
+            floor = keys[i];
+        } else {
+            moved.push_back(i);
+        }
+    }
+    if (moved.empty()) return order;
+    radixSort(keys);
+
+    size_t a = 0, b = 0;
+    while (a < kept.size() && b < moved.size()) { // Kept entries go first on equal keys
+        if (keys[moved[b]] < keys[kept[a]]) order.push_back(moved[b++]);
+        else order.push_back(kept[a++]);
+    }
+    order.insert(order.end(), kept.begin() + a, kept.end());
+    order.insert(order.end(), moved.begin() + b, moved.end());
+    return order;
+}
+
+// LSD radix sort of moved by key, skipping bytes every moved key shares (the high bytes, for nearby entities)
+void SpatialSorter::radixSort(std::span<const uint32_t> keys) {
+    uint32_t all = 0xFFFFFFFFu, any = 0; // Bits set in every key / in some key
+    for (uint32_t i : moved) {
+        all &= keys[i];
+        any |= keys[i];
+    }
+    scratch.resize(moved.size());
+    for (int shift = 0; shift < 32; shift += 8) {
+        if ((((all ^ any) >> shift) & 0xFF) == 0) continue; // Same byte everywhere: this pass would not move anything
+        size_t counts[257] = {};
+        for (uint32_t i : moved) counts[((keys[i] >> shift) & 0xFF) + 1]++;
+        for (int d = 0; d < 256; d++) counts[d + 1] += counts[d];
+        for (uint32_t i : moved) scratch[counts[(keys[i] >> shift) & 0xFF]++] = i;
+        moved.swap(scratch);
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef SPATIALSORT_H
+#define SPATIALSORT_H
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Key that has not been sorted yet (new entities); never equal to a real key's previous value
+const uint32_t UNSORTED_KEY = 0xFFFFFFFFu;
+
+// Z-order (Morton) code of a grid cell: interleaves the low 16 bits of x and y, so cells close in 2D get close keys
+constexpr uint32_t mortonCode(uint32_t x, uint32_t y) {
+    auto spread = [](uint32_t v) {
+        v &= 0xFFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(x) | (spread(y) << 1);
+}
+
+static_assert(mortonCode(0, 0) == 0 && mortonCode(1, 0) == 1 && mortonCode(0, 1) == 2 && mortonCode(3, 3) == 15);
+
+// Keeps an array ordered by key between sorts. Entries whose key is unchanged and still in order are left where
+// they are; only the rest are radix sorted and merged back in, so a mostly settled array costs one linear pass
+class SpatialSorter {
+public:
+    // Order that sorts entries by key: order()[i] is the old index of the entry that belongs at index i.
+    // lastKeys holds each entry's key from the previous sort (UNSORTED_KEY for entries added since).
+    // Returns an empty order when the array is already sorted
+    const std::vector<uint32_t>& sort(std::span<const uint32_t> keys, std::span<const uint32_t> lastKeys);
+
+    // Entries moved by the last sort (changed keys, new entries, or pushed out of order by removals)
+    size_t changedCount() const { return moved.size(); }
+
+    // Heap bytes held by the scratch arrays
+    size_t memoryBytes() const {
+        return (kept.capacity() + moved.capacity() + scratch.capacity() + order.capacity()) * sizeof(uint32_t);
+    }
+
+private:
+    // LSD radix sort of moved by key, one pass per key byte that differs between the entries
+    void radixSort(std::span<const uint32_t> keys);
+
+    std::vector<uint32_t> kept; // Indices still in order, in array order
+    std::vector<uint32_t> moved; // Indices that need sorting
+    std::vector<uint32_t> scratch; // Radix pass buffer
+    std::vector<uint32_t> order; // Result permutation
+};
+
+#endif
@@ -0,0 +1,82 @@
+#include "SpawnScheduler.h"
+#include <algorithm>
+
+// Scheduler tuning
+static const double SMOOTHING = 0.1; // Weight of the newest sample in the running averages
+static const int MAX_BATCH = 32; // Upper bound on spawns in one tick
+static const double INITIAL_SPAWN_COST = 0.00005; // Assumed cost of one spawn before any are measured
+
+// Constructor with the per-tick simulation budget in seconds
+SpawnScheduler::SpawnScheduler(double tickBudget)
+    : boxHeight(0), budget(tickBudget), avgTick(0.0), avgSpawn(INITIAL_SPAWN_COST) {}
+
+// Builds the surface table at runtime
+void SpawnScheduler::build(std::span<const SDL_Rect> solids, int w, int h, const SDL_Rect& bounds) {
+    surfaces.clear();
+    boxHeight = h;
+    computeSpawnSurfaces(solids, w, h, bounds, [&](const SpawnSurface& surface) { surfaces.push_back(surface); });
+    computeWeights();
+}
+
+// Uses a surface table baked offline for entities of height h
+void SpawnScheduler::load(const SpawnSurface* table, size_t count, int h) {
+    surfaces.assign(table, table + count);
+    boxHeight = h;
+    computeWeights();
+}
+
+// Rebuilds the running span totals used by pick()
+void SpawnScheduler::computeWeights() {
+    cumulative.clear();
+    float total = 0.0f;
+    for (const auto& surface : surfaces) {
+        total += surface.maxX - surface.minX + 1.0f; // +1 so single-position spans can still be picked
+        cumulative.push_back(total);
+    }
+}
+
+// Whether any valid surface exists
+bool SpawnScheduler::empty() const {
+    return surfaces.empty();
+}
+
+// Picks a surface with probability proportional to its span, then a uniform x on it
+void SpawnScheduler::pick(std::mt19937& gen, float& x, float& y) const {
+    std::uniform_real_distribution<float> dist(0.0f, cumulative.back());
+    float r = dist(gen);
+    size_t i = std::upper_bound(cumulative.begin(), cumulative.end(), r) - cumulative.begin();
+    if (i >= surfaces.size()) i = surfaces.size() - 1;
+    const SpawnSurface& surface = surfaces[i];
+    float start = (i == 0) ? 0.0f : cumulative[i - 1];
+    x = std::min(surface.maxX, surface.minX + (r - start)); // Reuse the remainder as the offset along the span
+    y = surface.y;
+}
+
+// Records how long the last tick's simulation took (excluding spawning)
+void SpawnScheduler::recordTick(double seconds) {
+    avgTick += (seconds - avgTick) * SMOOTHING;
+}
+
+// Records how long a batch of spawns took
+void SpawnScheduler::recordSpawns(int count, double seconds) {
+    if (count <= 0) return;
+    avgSpawn += (seconds / count - avgSpawn) * SMOOTHING;
+}
+
+// Spawns allowed this tick: whatever fits in the budget left over by the simulation, at least one so queues drain
+int SpawnScheduler::allowance(int wanted) const {
+    if (wanted <= 0) return 0;
+    double spare = budget - avgTick;
+    int fit = avgSpawn > 0.0 ? static_cast<int>(spare / avgSpawn) : MAX_BATCH;
+    return std::max(1, std::min(std::min(wanted, fit), MAX_BATCH));
+}
+
+// Height of the entity box the surfaces were built for
+int SpawnScheduler::getBoxHeight() const {
+    return boxHeight;
+}
+
+// Read-only view of the surface table
+const std::vector<SpawnSurface>& SpawnScheduler::getSurfaces() const {
+    return surfaces;
+}
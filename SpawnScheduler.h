@@ -0,0 +1,110 @@
+#ifndef SPAWNSCHEDULER_H
+#define SPAWNSCHEDULER_H
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <array>
+#include <random>
+#include <span>
+#include <utility>
+#include <vector>
+
+// A horizontal run of positions where an entity's left edge can stand on a surface with full headroom
+struct SpawnSurface {
+    float minX; // Leftmost valid x
+    float maxX; // Rightmost valid x
+    float y; // Entity top y when standing on the surface
+};
+
+// Computes the spawn surfaces for entities of size w x h standing on the solids, clipped to bounds: each solid's top,
+// minus the parts where another solid cuts into the entity's box. emit(surface) is called once per surface.
+// constexpr so built-in levels can bake their table at compile time
+template <typename Emit>
+constexpr void computeSpawnSurfaces(std::span<const SDL_Rect> solids, int w, int h, const SDL_Rect& bounds, Emit emit) {
+    std::vector<std::pair<float, float>> spans; // Scratch list of open spans on one surface
+    std::vector<std::pair<float, float>> cut;
+    for (const auto& solid : solids) {
+        float top = static_cast<float>(solid.y);
+        float lo = static_cast<float>(std::max(solid.x, bounds.x));
+        float hi = static_cast<float>(std::min(solid.x + solid.w, bounds.x + bounds.w) - w);
+        if (hi < lo || top - h < bounds.y) continue;
+        spans.assign(1, {lo, hi});
+        for (const auto& other : solids) {
+            if (other.y >= top || other.y + other.h <= top - h) continue; // No vertical overlap with the entity box
+            float blockLo = static_cast<float>(other.x - w); // Left edges strictly between these overlap the blocker
+            float blockHi = static_cast<float>(other.x + other.w);
+            cut.clear();
+            for (const auto& span : spans) {
+                if (span.second <= blockLo || span.first >= blockHi) { cut.push_back(span); continue; }
+                if (span.first <= blockLo) cut.push_back({span.first, blockLo});
+                if (span.second >= blockHi) cut.push_back({blockHi, span.second});
+            }
+            spans.swap(cut);
+        }
+        for (const auto& span : spans) emit(SpawnSurface{span.first, span.second, top - h});
+    }
+}
+
+// Number of spawn surfaces computeSpawnSurfaces() produces, for sizing a compile-time table
+constexpr size_t countSpawnSurfaces(std::span<const SDL_Rect> solids, int w, int h, const SDL_Rect& bounds) {
+    size_t count = 0;
+    computeSpawnSurfaces(solids, w, h, bounds, [&](const SpawnSurface&) { count++; });
+    return count;
+}
+
+// Spawn surface table as a fixed-size array; COUNT must come from countSpawnSurfaces() with the same arguments
+template <size_t COUNT>
+constexpr std::array<SpawnSurface, COUNT> spawnSurfaceTable(std::span<const SDL_Rect> solids, int w, int h, const SDL_Rect& bounds) {
+    std::array<SpawnSurface, COUNT> table{};
+    size_t i = 0;
+    computeSpawnSurfaces(solids, w, h, bounds, [&](const SpawnSurface& surface) { if (i < COUNT) table[i++] = surface; });
+    return table;
+}
+
+// Picks spawn positions from a precomputed surface table and spreads spawn bursts across ticks
+class SpawnScheduler {
+public:
+    // Constructor with the per-tick simulation budget in seconds
+    explicit SpawnScheduler(double tickBudget);
+
+    // Builds the surface table from solid pixel rects for entities of size w x h, clipped to bounds
+    void build(std::span<const SDL_Rect> solids, int w, int h, const SDL_Rect& bounds);
+
+    // Uses a surface table baked offline for entities of height h
+    void load(const SpawnSurface* table, size_t count, int h);
+
+    // Whether any valid surface exists
+    bool empty() const;
+
+    // Picks a position, weighting surfaces by span length
+    void pick(std::mt19937& gen, float& x, float& y) const;
+
+    // Records how long the last tick's simulation took (excluding spawning)
+    void recordTick(double seconds);
+
+    // Records how long a batch of spawns took
+    void recordSpawns(int count, double seconds);
+
+    // Number of spawns (at most wanted) that fit in the remaining budget this tick
+    int allowance(int wanted) const;
+
+    // Height of the entity box the surfaces were built for
+    int getBoxHeight() const;
+
+    // Read-only view of the surface table
+    const std::vector<SpawnSurface>& getSurfaces() const;
+
+private:
+    // Rebuilds the running span totals used by pick()
+    void computeWeights();
+
+
+    std::vector<SpawnSurface> surfaces; // Valid spawn spans
+    std::vector<float> cumulative; // Running total of span weights for weighted picking
+    int boxHeight; // Entity height the surfaces were built for
+    double budget; // Per-tick simulation budget in seconds
+    double avgTick; // Smoothed tick cost in seconds
+    double avgSpawn; // Smoothed cost of one spawn in seconds
+};
+
+#endif
@@ -0,0 +1,38 @@
+// Shared state reader: maps the segment a game publishes with --shared-state and prints one line per second.
+// Usage: statewatch <name> [seconds]
+// Doubles as the reference reader for external tools: map once with sharedStateMap, then call sharedStateRead
+// whenever a frame is wanted. Reading never blocks or slows the game
+#include "SharedState.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    if (argc != 2 && argc != 3) {
+        std::cerr << "Usage: statewatch <name> [seconds]\n";
+        return 1;
+    }
+    int seconds = argc == 3 ? std::atoi(argv[2]) : 0; // 0 watches until interrupted
+    const SharedStateHeader* header = sharedStateMap(argv[1]);
+    if (!header) return 1;
+    const char* const SCREENS[] = {"playing", "paused", "game over", "victory", "menu"};
+    SharedFrame frame;
+    std::vector<SharedEntity> zombies, food;
+    for (int second = 0; seconds == 0 || second < seconds; second++) {
+        if (!sharedStateRead(header, frame, zombies, food)) {
+            std::cout << "no consistent frame (the game kept writing)\n";
+        } else {
+            const char* screen = frame.screen >= 0 && frame.screen <= SHARED_MENU ? SCREENS[frame.screen] : "?";
+            std::printf("frame %llu  %.1f s  %-9s  score %d  wave %d (+%d queued)  player (%.0f, %.0f) hp %d  zombies %zu%s  food %zu\n",
+                        static_cast<unsigned long long>(frame.frame), frame.time, screen, frame.score, frame.wave, frame.pendingSpawns,
+                        frame.player.x, frame.player.y, frame.player.health, zombies.size(), frame.zombiesDropped ? "+" : "", food.size());
+            std::fflush(stdout);
+        }
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    sharedStateUnmap(header);
+    return 0;
+}
@@ -0,0 +1,255 @@
+#include "Terrain.h"
+#include <algorithm>
+#include <cmath>
+
+// Constructor viewing baked tables
+Terrain::Terrain(std::span<const Platform> plats, std::span<const SDL_Rect> pixelRects, const uint64_t* solidBits, int cols_, int rows_, int tileSize_)
+    : platforms(plats), rects(pixelRects), solid(solidBits), cols(cols_), rows(rows_), tileSize(tileSize_),
+      indestructibleRow(rows_ - 1), revision(0) {
+    buildEmptyRuns();
+}
+
+// Constructor viewing a level file's tables
+Terrain::Terrain(const Level& level)
+    : Terrain(level.getPlatforms(), level.getPlatformRects(), level.getSolidBits(), level.getCols(), level.getRows(), level.getTileSize()) {}
+
+// Adds a moving platform at the start of its path; returns its index
+int Terrain::addMover(const MoverPath& path) {
+    if (moverCount.empty()) {
+        size_t cells = static_cast<size_t>(cols) * rows;
+        moverCount.assign(cells, 0);
+        moverBits.assign((cells + 63) / 64, 0);
+    }
+    MovingPlatform mover;
+    mover.path = path;
+    mover.rect = {path.startX, path.startY, path.width, path.height};
+    mover.progress = 0.0f;
+    float length = std::hypot(static_cast<float>(path.endX - path.startX), static_cast<float>(path.endY - path.startY));
+    mover.step = length > 0.0f ? path.speed / length : 0.0f;
+    mover.dx = 0;
+    mover.dy = 0;
+    moveCells({0, 0, 0, 0}, mover.rect);
+    movers.push_back(mover);
+    return static_cast<int>(movers.size()) - 1;
+}
+
+// Steps every moving platform, turning around at the ends of its path
+void Terrain::updateMovers() {
+    for (auto& mover : movers) {
+        mover.progress += mover.step;
+        if (mover.progress >= 1.0f || mover.progress <= 0.0f) {
+            mover.progress = std::clamp(mover.progress, 0.0f, 1.0f);
+            mover.step = -mover.step; // Turn around
+        }
+        const MoverPath& path = mover.path;
+        SDL_Rect next = {
+            path.startX + static_cast<int>(std::lround((path.endX - path.startX) * mover.progress)),
+            path.startY + static_cast<int>(std::lround((path.endY - path.startY) * mover.progress)),
+            path.width, path.height};
+        mover.dx = next.x - mover.rect.x;
+        mover.dy = next.y - mover.rect.y;
+        if (mover.dx != 0 || mover.dy != 0) {
+            moveCells(mover.rect, next);
+            mover.rect = next;
+        }
+    }
+}
+
+// Tile range covered by a pixel rect, clipped to the grid
+void Terrain::cellRange(const SDL_Rect& rect, int& c0, int& r0, int& c1, int& r1) const {
+    if (rect.w <= 0 || rect.h <= 0) {
+        c0 = r0 = 0;
+        c1 = r1 = -1;
+        return;
+    }
+    c0 = std::max(0, rect.x / tileSize);
+    r0 = std::max(0, rect.y / tileSize);
+    c1 = std::min(cols - 1, (rect.x + rect.w - 1) / tileSize);
+    r1 = std::min(rows - 1, (rect.y + rect.h - 1) / tileSize);
+}
+
+// Moves a platform's footprint from one rect to another: cells covered by both keep their count
+void Terrain::moveCells(const SDL_Rect& from, const SDL_Rect& to) {
+    int fc0, fr0, fc1, fr1, tc0, tr0, tc1, tr1;
+    cellRange(from, fc0, fr0, fc1, fr1);
+    cellRange(to, tc0, tr0, tc1, tr1);
+    if (fc0 == tc0 && fr0 == tr0 && fc1 == tc1 && fr1 == tr1) return; // Still inside the same cells
+    for (int r = fr0; r <= fr1; r++) {
+        for (int c = fc0; c <= fc1; c++) {
+            if (c < tc0 || c > tc1 || r < tr0 || r > tr1) adjustCell(c, r, -1); // Cell left behind
+        }
+    }
+    for (int r = tr0; r <= tr1; r++) {
+        for (int c = tc0; c <= tc1; c++) {
+            if (c < fc0 || c > fc1 || r < fr0 || r > fr1) adjustCell(c, r, 1); // Cell entered
+        }
+    }
+}
+
+// Adds delta to a tile's moving platform count and keeps its bit in sync
+void Terrain::adjustCell(int c, int r, int delta) {
+    size_t cell = static_cast<size_t>(r) * cols + c;
+    moverCount[cell] = static_cast<uint8_t>(moverCount[cell] + delta);
+    uint64_t mask = uint64_t(1) << (cell & 63);
+    if (moverCount[cell]) moverBits[cell >> 6] |= mask;
+    else moverBits[cell >> 6] &= ~mask;
+}
+
+// Range of tiles covering the pixel span [lo, hi) along one axis
+static void tileSpan(float lo, float hi, int tileSize, int& first, int& last) {
+    first = static_cast<int>(std::floor(lo / tileSize));
+    last = static_cast<int>(std::ceil(hi / tileSize)) - 1;
+}
+
+// Top of a solid tile under [left, right) whose top is at most tolerance above feetY
+// Also reports the pixel extent [runLeft, runRight) of the run of exposed tiles the top belongs to
+bool Terrain::floorTop(float left, float right, float feetY, float tolerance, float& top, float& runLeft, float& runRight) const {
+    int r = static_cast<int>(std::floor(feetY / tileSize));
+    float rowTop = static_cast<float>(r * tileSize);
+    if (feetY - rowTop > tolerance) return false;
+    int c0, c1;
+    tileSpan(left, right, tileSize, c0, c1);
+    for (int c = c0; c <= c1; c++) {
+        if (solidTile(c, r) && !solidTile(c, r - 1)) { // Only the exposed top of a platform
+            int first = c, last = c;
+            while (solidTile(first - 1, r) && !solidTile(first - 1, r - 1)) first--;
+            while (solidTile(last + 1, r) && !solidTile(last + 1, r - 1)) last++;
+            top = rowTop;
+            runLeft = static_cast<float>(first * tileSize);
+            runRight = static_cast<float>((last + 1) * tileSize);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Bottom of the solid column hit by a head at headY across [left, right)
+bool Terrain::ceilingBottom(float left, float right, float headY, float& bottom) const {
+    int r = static_cast<int>(std::floor(headY / tileSize));
+    int c0, c1;
+    tileSpan(left, right, tileSize, c0, c1);
+    for (int c = c0; c <= c1; c++) {
+        if (!solidTile(c, r)) continue;
+        int end = r;
+        while (solidTile(c, end + 1)) end++; // Platforms can be several tiles thick
+        bottom = static_cast<float>((end + 1) * tileSize);
+        return true;
+    }
+    return false;
+}
+
+// Right edge of the solid run a left side at x runs into across [top, bottom)
+bool Terrain::wallRightEdge(float x, float top, float bottom, float& edge) const {
+    int c = static_cast<int>(std::floor(x / tileSize));
+    int r0, r1;
+    tileSpan(top, bottom, tileSize, r0, r1);
+    for (int r = r0; r <= r1; r++) {
+        if (!solidTile(c, r)) continue;
+        int end = c;
+        while (solidTile(end + 1, r)) end++;
+        edge = static_cast<float>((end + 1) * tileSize);
+        return true;
+    }
+    return false;
+}
+
+// Left edge of the solid run a right side at x runs into across [top, bottom)
+bool Terrain::wallLeftEdge(float x, float top, float bottom, float& edge) const {
+    int c = static_cast<int>(std::floor(x / tileSize));
+    int r0, r1;
+    tileSpan(top, bottom, tileSize, r0, r1);
+    for (int r = r0; r <= r1; r++) {
+        if (!solidTile(c, r)) continue;
+        int start = c;
+        while (solidTile(start - 1, r)) start--;
+        edge = static_cast<float>(start * tileSize);
+        return true;
+    }
+    return false;
+}
+
+// Copies the baked bitset so tiles can be edited (once, on the first destruction)
+void Terrain::makeMutable() {
+    if (!ownedSolid.empty()) return;
+    size_t words = (static_cast<size_t>(cols) * rows + 63) / 64;
+    ownedSolid.assign(solid, solid + words);
+    solid = ownedSolid.data();
+}
+
+// Clears a solid tile
+void Terrain::clearTile(int c, int r) {
+    size_t bit = static_cast<size_t>(r) * cols + c;
+    ownedSolid[bit >> 6] &= ~(uint64_t(1) << (bit & 63));
+    for (int x = c; x >= 0 && !solidTile(x, r); x--) refreshRun(x, r); // The run now reaches through this tile
+}
+
+// Destroys the destructible tiles whose centers lie within radius pixels of (x, y)
+int Terrain::destroyCircle(float x, float y, float radius) {
+    int c0 = std::max(0, static_cast<int>(std::floor((x - radius) / tileSize)));
+    int c1 = std::min(cols - 1, static_cast<int>(std::floor((x + radius) / tileSize)));
+    int r0 = std::max(0, static_cast<int>(std::floor((y - radius) / tileSize)));
+    int r1 = std::min(indestructibleRow - 1, static_cast<int>(std::floor((y + radius) / tileSize)));
+    int destroyed = 0;
+    SDL_Rect damaged = {0, 0, 0, 0}; // Tile range actually cleared
+    for (int r = r0; r <= r1; r++) {
+        for (int c = c0; c <= c1; c++) {
+            if (!solidTile(c, r)) continue;
+            float dx = (c + 0.5f) * tileSize - x;
+            float dy = (r + 0.5f) * tileSize - y;
+            if (dx * dx + dy * dy > radius * radius) continue;
+            makeMutable();
+            clearTile(c, r);
+            if (destroyed == 0) revision++; // Cached contacts from before this call are stale
+            if (destroyed == 0) damaged = {c, r, 1, 1};
+            int left = std::min(damaged.x, c), right = std::max(damaged.x + damaged.w, c + 1);
+            int top = std::min(damaged.y, r), bottom = std::max(damaged.y + damaged.h, r + 1);
+            damaged = {left, top, right - left, bottom - top};
+            destroyed++;
+        }
+    }
+    if (destroyed > 0) {
+        dirtyRegions.push_back({damaged.x * tileSize, damaged.y * tileSize, damaged.w * tileSize, damaged.h * tileSize});
+    }
+    return destroyed;
+}
+
+// Builds the empty runs for the whole grid
+void Terrain::buildEmptyRuns() {
+    emptyRun.assign(static_cast<size_t>(cols) * rows, 0);
+    for (int r = 0; r < rows; r++) {
+        for (int c = cols - 1; c >= 0; c--) refreshRun(c, r);
+    }
+}
+
+// Recomputes one cell's empty run from the cell to its right
+void Terrain::refreshRun(int c, int r) {
+    size_t cell = static_cast<size_t>(r) * cols + c;
+    int next = c + 1 < cols ? emptyRun[cell + 1] : 0;
+    emptyRun[cell] = solidTile(c, r) ? 0 : static_cast<uint8_t>(std::min(255, next + 1));
+}
+
+// Copies the bitset and reserves the edit buffers up front
+void Terrain::prepareEdits() {
+    makeMutable();
+    dirtyRegions.reserve(16);
+}
+
+// Heap bytes held by the terrain's own tables
+size_t Terrain::memoryBytes() const {
+    return ownedSolid.capacity() * sizeof(uint64_t) + dirtyRegions.capacity() * sizeof(SDL_Rect) +
+           emptyRun.capacity() + moverCount.capacity() + moverBits.capacity() * sizeof(uint64_t) +
+           movers.capacity() * sizeof(MovingPlatform);
+}
+
+// Makes rows from row down to the bottom of the grid indestructible
+void Terrain::setIndestructibleFrom(int row) {
+    indestructibleRow = std::clamp(row, 0, rows);
+}
+
+// Pops the pixel rect of the next damaged region; false when none are left
+bool Terrain::popDirtyRegion(SDL_Rect& region) {
+    if (dirtyRegions.empty()) return false;
+    region = dirtyRegions.back();
+    dirtyRegions.pop_back();
+    return true;
+}
@@ -0,0 +1,156 @@
+#ifndef TERRAIN_H
+#define TERRAIN_H
+
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Level.h"
+
+// Kinematic platform moving back and forth along a path, carrying whatever stands on it
+struct MovingPlatform {
+    MoverPath path; // End points, size and speed
+    SDL_Rect rect; // Current pixel rect
+    float progress; // Fraction of the path covered, 0 at the start point and 1 at the end point
+    float step; // Change of progress per tick (negative on the way back)
+    int dx, dy; // Displacement of the last step, applied to riders
+};
+
+// Collision detection against tile terrain (viewing baked tables, built-in or from a level file) and moving platforms.
+// Tiles can be destroyed: the baked bitset is copied on the first destruction and edited in place from then on
+class Terrain {
+public:
+    std::span<const Platform> platforms; // Static platforms in tile units
+    std::span<const SDL_Rect> rects; // Pixel rect of each static platform
+    std::vector<MovingPlatform> movers; // Moving platforms
+
+    // Constructor viewing baked tables
+    Terrain(std::span<const Platform> plats, std::span<const SDL_Rect> pixelRects, const uint64_t* solidBits, int cols_, int rows_, int tileSize_);
+
+    // Constructor viewing a level file's tables
+    explicit Terrain(const Level& level);
+
+    // Whether a tile is solid (moving platforms excluded); tiles outside the grid are empty
+    bool solidTile(int c, int r) const {
+        if (c < 0 || r < 0 || c >= cols || r >= rows) return false;
+        size_t bit = static_cast<size_t>(r) * cols + c;
+        return (solid[bit >> 6] >> (bit & 63)) & 1;
+    }
+
+    // Check if a pixel is solid: one bit lookup for tiles; moving platforms are only tested in tiles they overlap
+    bool getSolid(int x, int y) const {
+        if (x < 0 || y < 0) return false; // Left of or above the grid
+        int c = x / tileSize, r = y / tileSize;
+        if (c >= cols || r >= rows) return false; // Right of or below the grid
+        size_t bit = static_cast<size_t>(r) * cols + c;
+        if ((solid[bit >> 6] >> (bit & 63)) & 1) return true;
+        if (moverBits.empty() || !((moverBits[bit >> 6] >> (bit & 63)) & 1)) return false;
+        for (const auto& mover : movers) {
+            const SDL_Rect& m = mover.rect;
+            if (x >= m.x && x < m.x + m.w && y >= m.y && y < m.y + m.h) return true;
+        }
+        return false;
+    }
+
+    // Adds a moving platform at the start of its path; returns its index
+    int addMover(const MoverPath& path);
+
+    // Steps every moving platform along its path, updating only the grid cells each one leaves or enters
+    void updateMovers();
+
+    // Index of the first moving platform whose rect passes test(rect), or -1
+    template <typename Test>
+    int findMover(Test test) const {
+        for (size_t i = 0; i < movers.size(); i++) {
+            if (test(movers[i].rect)) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // Tile snapping. Each looks only at the tiles under the given span, so the cost does not depend on the level size.
+    // Top of an exposed solid tile under [left, right) whose top is at most tolerance above feetY,
+    // with the pixel extent of the run of exposed tiles it belongs to
+    bool floorTop(float left, float right, float feetY, float tolerance, float& top, float& runLeft, float& runRight) const;
+    // Bottom of the solid column hit by a head at headY across [left, right)
+    bool ceilingBottom(float left, float right, float headY, float& bottom) const;
+    // Right edge of the solid run a left side at x runs into across [top, bottom)
+    bool wallRightEdge(float x, float top, float bottom, float& edge) const;
+    // Left edge of the solid run a right side at x runs into across [top, bottom)
+    bool wallLeftEdge(float x, float top, float bottom, float& edge) const;
+
+    // Destroys the destructible tiles whose centers lie within radius pixels of (x, y).
+    // Costs time proportional to the damaged area. Returns the number of tiles destroyed
+    int destroyCircle(float x, float y, float radius);
+
+    // Copies the bitset and reserves the edit buffers now, so the first crater does not allocate mid-game
+    void prepareEdits();
+
+    // Makes rows from row down to the bottom of the grid indestructible (by default only the bottom row)
+    void setIndestructibleFrom(int row);
+
+    // Pops the pixel rect of the next damaged region so caches can refresh just that part; false when none are left
+    bool popDirtyRegion(SDL_Rect& region);
+
+    // Grid size in tiles
+    int getCols() const { return cols; }
+    int getRows() const { return rows; }
+
+    // Tile size in pixels
+    int getTileSize() const { return tileSize; }
+
+    // Whether a w x h pixel box at (x, y) overlaps no static solid tile (moving platforms excluded): one lookup per
+    // tile row the box covers, in per-tile empty runs built at load and patched on destruction
+    bool boxFits(float x, float y, int w, int h) const {
+        int c0 = std::max(0, static_cast<int>(std::floor(x / tileSize)));
+        int c1 = std::min(cols, static_cast<int>(std::ceil((x + w) / tileSize))) - 1;
+        int r0 = std::max(0, static_cast<int>(std::floor(y / tileSize)));
+        int r1 = std::min(rows, static_cast<int>(std::ceil((y + h) / tileSize))) - 1;
+        for (int r = r0; r <= r1 && c0 <= c1; r++) {
+            if (emptyRun[static_cast<size_t>(r) * cols + c0] <= c1 - c0) return false; // Solid tile inside [c0, c1]
+        }
+        return true;
+    }
+
+    // Counter bumped whenever tiles change; contacts cached under an older revision must be queried again
+    unsigned getRevision() const { return revision; }
+
+    // Heap bytes held by the terrain's own tables (the baked tables it views are not included)
+    size_t memoryBytes() const;
+
+private:
+    // Tile range covered by a pixel rect, clipped to the grid (empty when c0 > c1 or r0 > r1)
+    void cellRange(const SDL_Rect& rect, int& c0, int& r0, int& c1, int& r1) const;
+
+    // Moves a platform's footprint in the occupancy grid from one rect to another, touching only the cells that differ
+    void moveCells(const SDL_Rect& from, const SDL_Rect& to);
+
+    // Adds delta to a tile's moving platform count and keeps its bit in sync
+    void adjustCell(int c, int r, int delta);
+
+    // Copies the baked bitset so tiles can be edited (once, on the first destruction)
+    void makeMutable();
+
+    // Clears a solid tile
+    void clearTile(int c, int r);
+
+    // Builds the empty runs for the whole grid
+    void buildEmptyRuns();
+
+    // Recomputes one cell's empty run from the cell to its right
+    void refreshRun(int c, int r);
+
+    const uint64_t* solid; // Collision bitset, one bit per tile: the baked table, or ownedSolid once edited
+    std::vector<uint64_t> ownedSolid; // Editable copy of the bitset
+    std::vector<SDL_Rect> dirtyRegions; // Damaged pixel regions not yet picked up by caches
+    int cols, rows; // Grid size in tiles
+    int tileSize; // Tile size in pixels
+    int indestructibleRow; // First row that cannot be destroyed
+    unsigned revision; // Bumped on every tile change
+    std::vector<uint8_t> emptyRun; // Per tile: empty tiles from it to the right up to the next solid tile (capped at 255)
+    std::vector<uint8_t> moverCount; // Number of moving platforms overlapping each tile
+    std::vector<uint64_t> moverBits; // Tiles overlapped by at least one moving platform
+};
+
+#endif
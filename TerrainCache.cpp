@@ -0,0 +1,59 @@
+#include "TerrainCache.h"
+#include <iostream>
+
+// Default constructor
+TerrainCache::TerrainCache() : texture(nullptr), width(0), height(0) {}
+
+// Creates the cache texture and draws the whole terrain into it
+bool TerrainCache::init(SDL_Renderer* renderer, int w, int h, DrawRegion draw) {
+    cleanup();
+    texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET, w, h);
+    if (!texture) {
+        std::cerr << "Failed to create terrain cache texture: " << SDL_GetError() << "\n";
+        return false;
+    }
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND); // Empty tiles stay transparent
+    width = w;
+    height = h;
+    drawRegion = draw;
+    dirty.clear();
+    dirty.reserve(16); // Craters are queued without allocating mid-game
+    redraw(renderer, {0, 0, w, h});
+    return true;
+}
+
+// Marks a pixel region for redrawing before the next render
+void TerrainCache::invalidate(const SDL_Rect& region) {
+    dirty.push_back(region);
+}
+
+// Redraws the invalidated regions, then copies the cache to the screen
+void TerrainCache::render(SDL_Renderer* renderer) {
+    if (!texture) return;
+    for (const auto& region : dirty) redraw(renderer, region);
+    dirty.clear();
+    SDL_Rect dst = {0, 0, width, height};
+    SDL_RenderCopy(renderer, texture, nullptr, &dst);
+}
+
+// Frees the cache texture
+void TerrainCache::cleanup() {
+    if (texture) SDL_DestroyTexture(texture);
+    texture = nullptr;
+}
+
+// Clears a region of the cache to transparent and draws it again
+void TerrainCache::redraw(SDL_Renderer* renderer, const SDL_Rect& region) {
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    SDL_BlendMode previousBlend;
+    SDL_GetRenderDrawBlendMode(renderer, &previousBlend);
+    SDL_SetRenderTarget(renderer, texture);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE); // Overwrite alpha instead of blending
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderFillRect(renderer, &region);
+    SDL_SetRenderDrawBlendMode(renderer, previousBlend);
+    SDL_RenderSetClipRect(renderer, &region); // Tiles straddling the edge only repaint the part inside
+    drawRegion(renderer, region);
+    SDL_RenderSetClipRect(renderer, nullptr);
+    SDL_SetRenderTarget(renderer, previousTarget);
+}
@@ -0,0 +1,43 @@
+#ifndef TERRAINCACHE_H
+#define TERRAINCACHE_H
+
+#include <SDL2/SDL.h>
+#include <functional>
+#include <vector>
+
+// Terrain drawn once into a render texture and blitted each frame. Damaged regions are redrawn on their own,
+// so destruction never repaints the whole level
+class TerrainCache {
+public:
+    // Draws the terrain tiles inside a pixel region (the render target is already set and the region cleared)
+    using DrawRegion = std::function<void(SDL_Renderer*, const SDL_Rect&)>;
+
+    // Default constructor
+    TerrainCache();
+
+    // Creates the cache texture and draws the whole terrain into it
+    bool init(SDL_Renderer* renderer, int width, int height, DrawRegion draw);
+
+    // Marks a pixel region for redrawing before the next render
+    void invalidate(const SDL_Rect& region);
+
+    // Redraws the invalidated regions, then copies the cache to the screen
+    void render(SDL_Renderer* renderer);
+
+    // Frees the cache texture
+    void cleanup();
+
+    // Cache texture, for memory accounting (nullptr before init)
+    SDL_Texture* getTexture() const { return texture; }
+
+private:
+    // Clears a region of the cache and draws it again
+    void redraw(SDL_Renderer* renderer, const SDL_Rect& region);
+
+    SDL_Texture* texture; // Cached terrain image
+    int width, height; // Cache size in pixels
+    DrawRegion drawRegion; // Tile drawing callback
+    std::vector<SDL_Rect> dirty; // Regions to redraw
+};
+
+#endif
@@ -0,0 +1,196 @@
+#include "WaveDirector.h"
+#include "AllocTracker.h"
+#include <algorithm>
+
+// Wave tuning
+static const int ZOMBIES_PER_WAVE = 10; // Zombies in each standard wave
+static const double WAVE_REST = 2.0; // Seconds of calm after a standard wave is cleared
+static const double BOSS_CALM = 2.0; // Seconds of calm before the boss appears
+
+// Command kinds for WaveDirector::Command
+enum { CMD_SPAWN, CMD_CLEARED, CMD_WAIT, CMD_BOSS };
+
+// Standard wave: spawn a group, wait for it to die, then rest
+static WaveScript standardWave(WaveDirector& d, int count, double rest) {
+    co_await d.spawn(count);
+    co_await d.untilCleared();
+    co_await d.wait(rest);
+}
+
+// Boss wave: a short calm, then a boss that must be killed
+static WaveScript bossWave(WaveDirector& d, double calm) {
+    co_await d.wait(calm);
+    co_await d.spawnBoss();
+    co_await d.untilCleared();
+}
+
+// Move assignment, destroying any frame already owned
+WaveScript& WaveScript::operator=(WaveScript&& other) noexcept {
+    if (this != &other) {
+        if (handle) handle.destroy();
+        handle = other.handle;
+        other.handle = nullptr;
+    }
+    return *this;
+}
+
+// Destroys the coroutine frame
+WaveScript::~WaveScript() {
+    if (handle) handle.destroy();
+}
+
+// Runs the command immediately when possible; awaits before resumeStep are replayed without side effects
+bool WaveDirector::Command::await_ready() {
+    int index = director->step++;
+    if (index < director->resumeStep) return true; // Already done before the save
+    switch (op) {
+        case CMD_SPAWN:
+            director->pendingSpawns += count;
+            return true;
+        case CMD_BOSS:
+            director->pendingBosses++;
+            return true;
+        case CMD_WAIT:
+            if (index == director->resumeStep && director->restoredWait >= 0) seconds = director->restoredWait;
+            return seconds <= 0;
+        default: // CMD_CLEARED
+            return false;
+    }
+}
+
+// Parks the script until its wake condition holds
+void WaveDirector::Command::await_suspend(std::coroutine_handle<> h) {
+    if (op == CMD_WAIT) {
+        director->suspendedWake = director->now + seconds;
+        director->timed.push_back({director->suspendedWake, h});
+        std::push_heap(director->timed.begin(), director->timed.end(),
+                       [](const TimedWake& a, const TimedWake& b) { return a.wakeTime > b.wakeTime; });
+    } else {
+        director->clearWaiters.push_back(h);
+    }
+}
+
+// Constructor with the number of waves to run
+WaveDirector::WaveDirector(int totalWaves_)
+    : pendingSpawns(0), pendingBosses(0), wave(1), totalWaves(totalWaves_), finished(false),
+      step(0), resumeStep(0), restoredWait(-1), now(0), suspendedWake(0) {}
+
+// Starts wave 1
+void WaveDirector::start(double currentTime) {
+    wave = 1;
+    pendingSpawns = 0;
+    pendingBosses = 0;
+    finished = false;
+    beginWave(currentTime);
+}
+
+// Resumes a saved wave: its script fast-forwards to the saved await
+void WaveDirector::restore(const WaveResumeState& state, double currentTime) {
+    wave = std::max(1, std::min(state.wave, totalWaves));
+    pendingSpawns = state.pendingSpawns;
+    pendingBosses = state.pendingBosses;
+    finished = false;
+    resumeStep = state.step;
+    restoredWait = state.waitRemaining;
+    beginWave(currentTime);
+}
+
+// Begins running the script for the current wave
+void WaveDirector::beginWave(double currentTime) {
+    now = currentTime;
+    timed.clear();
+    clearWaiters.clear();
+    suspendedWake = 0;
+    step = 0;
+    script = makeScript(wave);
+    script.handle.resume(); // Runs until the first real suspension
+    resumeStep = 0;
+    restoredWait = -1;
+    checkScript();
+}
+
+// Rethrows the exception that ended the current script, if any
+void WaveDirector::checkScript() const {
+    if (script.handle && script.handle.promise().error) std::rethrow_exception(script.handle.promise().error);
+}
+
+// Creates the script for the given wave
+WaveScript WaveDirector::makeScript(int waveNumber) {
+    if (waveNumber < totalWaves) return standardWave(*this, ZOMBIES_PER_WAVE, WAVE_REST);
+    return bossWave(*this, BOSS_CALM);
+}
+
+// Resumes scripts whose wake time has passed or whose clear condition now holds
+void WaveDirector::update(double currentTime, int aliveZombies) {
+    if (finished) return;
+    AllocExempt exempt; // Resumed scripts may start the next wave, which allocates its coroutine frame
+    now = currentTime;
+    while (!timed.empty() && timed.front().wakeTime <= currentTime) {
+        std::pop_heap(timed.begin(), timed.end(),
+                      [](const TimedWake& a, const TimedWake& b) { return a.wakeTime > b.wakeTime; });
+        std::coroutine_handle<> h = timed.back().handle;
+        timed.pop_back();
+        suspendedWake = 0;
+        h.resume();
+    }
+    if (!clearWaiters.empty() && pendingSpawns == 0 && pendingBosses == 0 && aliveZombies == 0) {
+        std::vector<std::coroutine_handle<>> ready;
+        ready.swap(clearWaiters);
+        for (auto h : ready) h.resume();
+    }
+    checkScript(); // A script that threw is done too, but must not count as a completed wave
+    if (script.handle && script.handle.done()) {
+        if (wave < totalWaves) {
+            wave++; // Advance to next wave
+            beginWave(currentTime);
+        } else {
+            finished = true;
+        }
+    }
+}
+
+// Captures the compact resume state for saving
+WaveResumeState WaveDirector::save(double currentTime) const {
+    WaveResumeState state;
+    state.wave = wave;
+    state.step = step > 0 ? step - 1 : 0; // The last await started is the one suspended on
+    state.pendingSpawns = pendingSpawns;
+    state.pendingBosses = pendingBosses;
+    state.waitRemaining = suspendedWake > 0 ? std::max(0.0, suspendedWake - currentTime) : -1;
+    return state;
+}
+
+// Current wave (1-based)
+int WaveDirector::getWave() const {
+    return wave;
+}
+
+// Total number of waves
+int WaveDirector::getTotalWaves() const {
+    return totalWaves;
+}
+
+// True once the last wave's script has completed
+bool WaveDirector::isFinished() const {
+    return finished;
+}
+
+// Queue N zombies
+WaveDirector::Command WaveDirector::spawn(int count) {
+    return {this, CMD_SPAWN, count, 0};
+}
+
+// Wait until every queued zombie has spawned and died
+WaveDirector::Command WaveDirector::untilCleared() {
+    return {this, CMD_CLEARED, 0, 0};
+}
+
+// Wait T seconds
+WaveDirector::Command WaveDirector::wait(double seconds) {
+    return {this, CMD_WAIT, 0, seconds};
+}
+
+// Queue a boss
+WaveDirector::Command WaveDirector::spawnBoss() {
+    return {this, CMD_BOSS, 0, 0};
+}
@@ -0,0 +1,118 @@
+#ifndef WAVEDIRECTOR_H
+#define WAVEDIRECTOR_H
+
+#include <coroutine>
+#include <exception>
+#include <vector>
+
+class WaveDirector;
+
+// Coroutine type for one wave script. Starts suspended; the director resumes it
+struct WaveScript {
+    struct promise_type {
+        WaveScript get_return_object() { return WaveScript(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); } // Rethrown by the director
+
+        std::exception_ptr error; // Exception that ended the script, null if none
+    };
+
+    std::coroutine_handle<promise_type> handle; // Owned coroutine frame
+
+    // Constructors and move semantics (the frame is owned by exactly one script)
+    WaveScript() : handle(nullptr) {}
+    explicit WaveScript(std::coroutine_handle<promise_type> h) : handle(h) {}
+    WaveScript(WaveScript&& other) noexcept : handle(other.handle) { other.handle = nullptr; }
+    WaveScript& operator=(WaveScript&& other) noexcept;
+    WaveScript(const WaveScript&) = delete;
+    WaveScript& operator=(const WaveScript&) = delete;
+
+    // Destroys the coroutine frame
+    ~WaveScript();
+};
+
+// Compact state needed to resume a wave script after loading a save
+struct WaveResumeState {
+    int wave; // Current wave (1-based)
+    int step; // Index of the await the script is suspended on
+    int pendingSpawns; // Zombies queued but not yet spawned
+    int pendingBosses; // Bosses queued but not yet spawned
+    double waitRemaining; // Seconds left if suspended on a timed wait
+};
+
+// Runs wave scripts as coroutines. Suspended scripts cost nothing until their wake condition is met
+class WaveDirector {
+public:
+    // Awaitable returned by the script commands below
+    struct Command {
+        WaveDirector* director; // Owning director
+        int op; // Command kind
+        int count; // Zombies to spawn
+        double seconds; // Wait duration
+        bool await_ready();
+        void await_suspend(std::coroutine_handle<> h);
+        void await_resume() {}
+    };
+
+    int pendingSpawns; // Zombies queued by scripts, drained by the game at its own pace
+    int pendingBosses; // Bosses queued by scripts, drained by the game
+
+    // Constructor with the number of waves to run
+    explicit WaveDirector(int totalWaves);
+
+    // Starts wave 1, or resumes a saved wave when state is given
+    void start(double currentTime);
+    void restore(const WaveResumeState& state, double currentTime);
+
+    // Resumes scripts whose wake time has passed or whose clear condition now holds. An exception thrown by a
+    // script is rethrown here (or from start/restore) instead of ending the wave as if it had completed
+    void update(double currentTime, int aliveZombies);
+
+    // Captures the compact resume state for saving
+    WaveResumeState save(double currentTime) const;
+
+    // Current wave (1-based) and total waves
+    int getWave() const;
+    int getTotalWaves() const;
+
+    // True once the last wave's script has completed
+    bool isFinished() const;
+
+    // Script commands: queue N zombies, wait until all are dead, wait T seconds, queue a boss
+    Command spawn(int count);
+    Command untilCleared();
+    Command wait(double seconds);
+    Command spawnBoss();
+
+private:
+    // Timed wake entry for the scheduler heap
+    struct TimedWake {
+        double wakeTime; // Time to resume
+        std::coroutine_handle<> handle; // Suspended script
+    };
+
+    // Creates the script for the given wave
+    WaveScript makeScript(int waveNumber);
+
+    // Begins running the script for the current wave
+    void beginWave(double currentTime);
+
+    // Rethrows the exception that ended the current script, if any
+    void checkScript() const;
+
+    int wave; // Current wave (1-based)
+    int totalWaves; // Number of waves
+    bool finished; // Whether all waves are done
+    WaveScript script; // Script of the current wave
+    int step; // Await index reached by the current script
+    int resumeStep; // Awaits before this index are fast-forwarded after a restore
+    double restoredWait; // Remaining wait for the await at resumeStep
+    double now; // Time of the current update, used by timed waits
+    std::vector<TimedWake> timed; // Min-heap of timed waits
+    std::vector<std::coroutine_handle<>> clearWaiters; // Scripts waiting for the wave to be cleared
+    double suspendedWake; // Wake time of the current script's timed wait (0 if none)
+};
+
+#endif
@@ -40,6 +40,10 @@ public:
     // Frees texture resources
     void cleanup();
 
+    // Day and night background textures, for memory accounting
+    SDL_Texture* getDayTexture() const { return daytimeTex; }
+    SDL_Texture* getNightTexture() const { return nighttimeTex; }
+
 private:
     // Daytime background texture
     SDL_Texture* daytimeTex;
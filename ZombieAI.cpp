@@ -0,0 +1,296 @@
+#include "ZombieAI.h"
+#include <algorithm>
+#include <cmath>
+
+// Tuning for AI actions
+static const double LUNGE_COOLDOWN = 1.5; // Seconds between lunges
+static const float LUNGE_HOP = -6.0f; // Upward velocity of a lunge
+static const float CHASE_STOP_DISTANCE = 5.0f; // Chasers stop when this close to the player
+static const float SQUAD_RADIUS = 96.0f; // Largest distance from a leader at which squads form
+static const size_t MAX_SQUAD = 16; // Largest squad, leader included
+static const float FOLLOW_GAIN = 0.1f; // Fraction of its offset error a member corrects per tick
+
+// Appends a branch: conditions fall through on success and skip past the action on failure
+void BehaviorTree::addBranch(std::initializer_list<std::pair<BTOp, float>> conditions, BTOp action, float actionParam) {
+    uint8_t start = static_cast<uint8_t>(nodes.size());
+    uint8_t next = static_cast<uint8_t>(start + conditions.size() + 1); // First node of the following branch
+    uint8_t i = start;
+    for (const auto& cond : conditions) {
+        nodes.push_back({cond.first, static_cast<uint8_t>(i + 1), next, cond.second});
+        i++;
+    }
+    nodes.push_back({action, next, next, actionParam});
+}
+
+// Fast attackers: flee when hurt, lunge when close, climb toward the player, chase, else patrol
+BehaviorTree makeStalkerTree() {
+    BehaviorTree tree;
+    tree.addBranch({{BT_HEALTH_BELOW, 0.25f}}, BT_FLEE, 1.5f);
+    tree.addBranch({{BT_PLAYER_NEAR, 80.0f}, {BT_ON_GROUND, 0.0f}, {BT_LUNGE_READY, 0.0f}}, BT_LUNGE, 3.0f);
+    tree.addBranch({{BT_PLAYER_ABOVE, 48.0f}, {BT_ON_GROUND, 0.0f}, {BT_JUMP_REACHES, -13.0f}}, BT_CLIMB, -13.0f);
+    tree.addBranch({{BT_WALL_AHEAD, 0.0f}, {BT_ON_GROUND, 0.0f}}, BT_CLIMB, -10.0f);
+    tree.addBranch({{BT_PLAYER_NEAR, 500.0f}}, BT_CHASE, 1.0f);
+    tree.addBranch({}, BT_PATROL, 96.0f);
+    return tree;
+}
+
+// Slow tanks: climb toward the player, chase when in range, else patrol
+BehaviorTree makeBruteTree() {
+    BehaviorTree tree;
+    tree.addBranch({{BT_PLAYER_ABOVE, 64.0f}, {BT_ON_GROUND, 0.0f}, {BT_WALL_AHEAD, 0.0f}}, BT_CLIMB, -11.0f);
+    tree.addBranch({{BT_PLAYER_NEAR, 300.0f}}, BT_CHASE, 1.0f);
+    tree.addBranch({}, BT_PATROL, 64.0f);
+    return tree;
+}
+
+// Constructor registering the built-in AI profiles
+ZombieBrains::ZombieBrains() : jumps(nullptr) {
+    addTree("stalker", makeStalkerTree());
+    addTree("brute", makeBruteTree());
+}
+
+// Registers a named tree (AI profile) and returns its index
+int ZombieBrains::addTree(const std::string& name, const BehaviorTree& tree) {
+    trees.push_back(tree);
+    treeNames.push_back(name);
+    return static_cast<int>(trees.size()) - 1;
+}
+
+// Index of the named AI profile, or -1 if unknown
+int ZombieBrains::findTree(const std::string& name) const {
+    for (size_t i = 0; i < treeNames.size(); i++) {
+        if (treeNames[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// Reserves room for count slots in every blackboard array
+void ZombieBrains::reserve(size_t count) {
+    posX.reserve(count); posY.reserve(count); healthFrac.reserve(count);
+    onGround.reserve(count); wallAhead.reserve(count); cellX.reserve(count); cellY.reserve(count);
+    archetype.reserve(count); alive.reserve(count); speed.reserve(count);
+    homeX.reserve(count); facing.reserve(count); lungeReadyAt.reserve(count);
+    generation.reserve(count); leader.reserve(count); leaderGeneration.reserve(count); squadOffsetX.reserve(count);
+    moveX.reserve(count); jumpVel.reserve(count); action.reserve(count);
+    freeSlots.reserve(count);
+    size_t maxNodes = 0;
+    for (const auto& tree : trees) maxNodes = std::max(maxNodes, tree.nodes.size());
+    if (buckets.size() < maxNodes + 1) buckets.resize(maxNodes + 1);
+    for (auto& bucket : buckets) bucket.reserve(count);
+    mask.reserve(count);
+}
+
+// Heap bytes held by blackboards, trees and scratch lists
+size_t ZombieBrains::memoryBytes() const {
+    size_t bytes = (posX.capacity() + posY.capacity() + healthFrac.capacity() + speed.capacity() + homeX.capacity() +
+                    squadOffsetX.capacity() + moveX.capacity() + jumpVel.capacity()) * sizeof(float);
+    bytes += onGround.capacity() + wallAhead.capacity() + archetype.capacity() + alive.capacity() + facing.capacity() +
+             action.capacity() + mask.capacity();
+    bytes += (cellX.capacity() + cellY.capacity() + leader.capacity()) * sizeof(int32_t);
+    bytes += (generation.capacity() + leaderGeneration.capacity()) * sizeof(uint32_t);
+    bytes += lungeReadyAt.capacity() * sizeof(double) + freeSlots.capacity() * sizeof(int);
+    for (const auto& tree : trees) bytes += sizeof(BehaviorTree) + tree.nodes.capacity() * sizeof(BTNode);
+    for (const auto& bucket : buckets) bytes += sizeof(bucket) + bucket.capacity() * sizeof(uint32_t);
+    return bytes;
+}
+
+// Allocates a blackboard slot, reusing released slots first
+int ZombieBrains::allocate(int profile, float x, float baseSpeed) {
+    int slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slot = static_cast<int>(alive.size());
+        posX.push_back(0); posY.push_back(0); healthFrac.push_back(1.0f);
+        onGround.push_back(0); wallAhead.push_back(0); cellX.push_back(0); cellY.push_back(0);
+        archetype.push_back(0); alive.push_back(0); speed.push_back(0);
+        homeX.push_back(0); facing.push_back(1); lungeReadyAt.push_back(0);
+        generation.push_back(0); leader.push_back(-1); leaderGeneration.push_back(0); squadOffsetX.push_back(0);
+        moveX.push_back(0); jumpVel.push_back(0); action.push_back(BT_PATROL);
+    }
+    posX[slot] = x; homeX[slot] = x; healthFrac[slot] = 1.0f;
+    onGround[slot] = 0; wallAhead[slot] = 0; facing[slot] = 1; lungeReadyAt[slot] = 0;
+    archetype[slot] = static_cast<uint8_t>(profile);
+    speed[slot] = baseSpeed;
+    moveX[slot] = 0; jumpVel[slot] = 0; action[slot] = BT_PATROL;
+    generation[slot]++; leader[slot] = -1; // Lone until the next squad formation
+    alive[slot] = 1;
+    return slot;
+}
+
+// Frees a blackboard slot
+void ZombieBrains::release(int slot) {
+    if (slot < 0 || slot >= static_cast<int>(alive.size()) || !alive[slot]) return;
+    alive[slot] = 0;
+    freeSlots.push_back(slot);
+}
+
+// Uses a jump table for BT_JUMP_REACHES
+void ZombieBrains::setJumpTable(const JumpTable* table) {
+    jumps = table;
+}
+
+// Distinct jump forces tested by BT_JUMP_REACHES nodes
+std::vector<float> ZombieBrains::jumpForces() const {
+    std::vector<float> result;
+    for (const auto& tree : trees) {
+        for (const auto& node : tree.nodes) {
+            if (node.op == BT_JUMP_REACHES && std::find(result.begin(), result.end(), node.param) == result.end()) {
+                result.push_back(node.param);
+            }
+        }
+    }
+    return result;
+}
+
+// Regroups slots into squads: walks the slots in spatial order, so every squad is a run of nearby zombies
+void ZombieBrains::formSquads(std::span<const int> slots) {
+    int head = -1; // Leader of the squad being filled
+    size_t size = 0;
+    for (int s : slots) {
+        if (head >= 0 && size < MAX_SQUAD && std::fabs(posX[s] - posX[head]) <= SQUAD_RADIUS &&
+            std::fabs(posY[s] - posY[head]) <= SQUAD_RADIUS) {
+            leader[s] = head;
+            leaderGeneration[s] = generation[head];
+            squadOffsetX[s] = posX[s] - posX[head];
+            size++;
+        } else {
+            head = s; // Too far from the current leader: start a new squad
+            leader[s] = -1;
+            size = 1;
+        }
+    }
+}
+
+// Evaluates every tree one node at a time: all slots waiting on a node run through one tight loop,
+// then move forward to their next node. Each slot ends on exactly one action (or past the end, idle).
+void ZombieBrains::evaluate(float playerX, float playerY, double currentTime) {
+    for (size_t a = 0; a < trees.size(); a++) {
+        const std::vector<BTNode>& nodes = trees[a].nodes;
+        size_t nodeCount = nodes.size();
+        if (buckets.size() < nodeCount + 1) buckets.resize(nodeCount + 1);
+
+        // Every live leader or lone slot of this archetype starts at the root
+        for (uint32_t s = 0; s < alive.size(); s++) {
+            if (alive[s] && archetype[s] == a && !isFollower(s)) buckets[0].push_back(s);
+        }
+
+        for (size_t n = 0; n < nodeCount; n++) {
+            std::vector<uint32_t>& bucket = buckets[n];
+            if (bucket.empty()) continue;
+            const BTNode& node = nodes[n];
+            size_t count = bucket.size();
+            const uint32_t* ids = bucket.data();
+
+            if (node.op <= BT_JUMP_REACHES) {
+                // Condition: fill the mask in one branch-free pass, then route slots
+                mask.resize(count);
+                uint8_t* m = mask.data();
+                switch (node.op) {
+                    case BT_PLAYER_NEAR:
+                        for (size_t i = 0; i < count; i++) m[i] = std::fabs(playerX - posX[ids[i]]) < node.param;
+                        break;
+                    case BT_PLAYER_ABOVE:
+                        for (size_t i = 0; i < count; i++) m[i] = posY[ids[i]] - playerY > node.param;
+                        break;
+                    case BT_HEALTH_BELOW:
+                        for (size_t i = 0; i < count; i++) m[i] = healthFrac[ids[i]] < node.param;
+                        break;
+                    case BT_WALL_AHEAD:
+                        for (size_t i = 0; i < count; i++) m[i] = wallAhead[ids[i]];
+                        break;
+                    case BT_ON_GROUND:
+                        for (size_t i = 0; i < count; i++) m[i] = onGround[ids[i]];
+                        break;
+                    case BT_LUNGE_READY:
+                        for (size_t i = 0; i < count; i++) m[i] = currentTime >= lungeReadyAt[ids[i]];
+                        break;
+                    default: { // BT_JUMP_REACHES: one table lookup per slot
+                        int force = jumps ? jumps->forceClass(node.param) : -1;
+                        for (size_t i = 0; i < count; i++) {
+                            uint32_t s = ids[i];
+                            if (force < 0) { m[i] = 1; continue; }
+                            int dir = playerX > posX[s] ? 1 : -1; // Climbs jump toward the player
+                            int row = jumps->landingRow(cellX[s], cellY[s], jumps->speedClass(speed[s]), force, dir);
+                            m[i] = row >= 0 && row < cellY[s];
+                        }
+                        break;
+                    }
+                }
+                std::vector<uint32_t>& pass = buckets[node.onSuccess];
+                std::vector<uint32_t>& fail = buckets[node.onFailure];
+                for (size_t i = 0; i < count; i++) (m[i] ? pass : fail).push_back(ids[i]);
+            } else {
+                // Action: write outputs for the whole bucket
+                switch (node.op) {
+                    case BT_PATROL:
+                        for (size_t i = 0; i < count; i++) {
+                            uint32_t s = ids[i];
+                            float offset = posX[s] - homeX[s];
+                            if (wallAhead[s] || (offset > node.param && facing[s] > 0) || (offset < -node.param && facing[s] < 0)) {
+                                facing[s] = static_cast<int8_t>(-facing[s]); // Turn around at the patrol edge
+                            }
+                            moveX[s] = facing[s] * speed[s] * 0.5f;
+                            jumpVel[s] = 0;
+                        }
+                        break;
+                    case BT_CHASE:
+                        for (size_t i = 0; i < count; i++) {
+                            uint32_t s = ids[i];
+                            float dx = playerX - posX[s];
+                            facing[s] = dx > 0 ? 1 : -1;
+                            moveX[s] = std::fabs(dx) > CHASE_STOP_DISTANCE ? facing[s] * speed[s] * node.param : 0.0f;
+                            jumpVel[s] = 0;
+                            homeX[s] = posX[s]; // Patrol resumes where the chase was lost
+                        }
+                        break;
+                    case BT_LUNGE:
+                        for (size_t i = 0; i < count; i++) {
+                            uint32_t s = ids[i];
+                            facing[s] = playerX > posX[s] ? 1 : -1;
+                            moveX[s] = facing[s] * speed[s] * node.param;
+                            jumpVel[s] = LUNGE_HOP;
+                            lungeReadyAt[s] = currentTime + LUNGE_COOLDOWN;
+                        }
+                        break;
+                    case BT_FLEE:
+                        for (size_t i = 0; i < count; i++) {
+                            uint32_t s = ids[i];
+                            facing[s] = playerX > posX[s] ? -1 : 1;
+                            moveX[s] = facing[s] * speed[s] * node.param;
+                            jumpVel[s] = 0;
+                        }
+                        break;
+                    default: // BT_CLIMB
+                        for (size_t i = 0; i < count; i++) {
+                            uint32_t s = ids[i];
+                            facing[s] = playerX > posX[s] ? 1 : -1;
+                            moveX[s] = facing[s] * speed[s];
+                            jumpVel[s] = node.param;
+                        }
+                        break;
+                }
+                for (size_t i = 0; i < count; i++) action[ids[i]] = node.op;
+            }
+            bucket.clear();
+        }
+
+        // Slots that fell off the end of the tree stand still
+        std::vector<uint32_t>& idle = buckets[nodeCount];
+        for (uint32_t s : idle) { moveX[s] = 0; jumpVel[s] = 0; }
+        idle.clear();
+    }
+
+    // Squad members take their leader's decision, corrected toward their place beside it
+    for (uint32_t s = 0; s < alive.size(); s++) {
+        if (!alive[s] || !isFollower(s)) continue;
+        int l = leader[s];
+        float steer = std::clamp((posX[l] + squadOffsetX[s] - posX[s]) * FOLLOW_GAIN, -speed[s], speed[s]);
+        moveX[s] = moveX[l] + steer;
+        jumpVel[s] = jumpVel[l];
+        facing[s] = facing[l];
+        action[s] = action[l];
+        homeX[s] = posX[s]; // Patrol from here if the squad breaks up
+    }
+}
@@ -0,0 +1,134 @@
+#ifndef ZOMBIEAI_H
+#define ZOMBIEAI_H
+
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include "JumpTable.h"
+
+// Behavior tree opcodes. Conditions branch to onSuccess/onFailure, actions end the agent's tick
+enum BTOp : uint8_t {
+    BT_PLAYER_NEAR,  // Player within param pixels horizontally
+    BT_PLAYER_ABOVE, // Player more than param pixels above the zombie
+    BT_HEALTH_BELOW, // Health fraction below param
+    BT_WALL_AHEAD,   // Terrain blocks the facing direction
+    BT_ON_GROUND,    // Zombie is standing on a platform
+    BT_LUNGE_READY,  // Lunge cooldown has expired
+    BT_JUMP_REACHES, // A jump of force param toward the player lands on a higher ledge (per the jump table)
+    BT_PATROL,       // Walk back and forth within param pixels of the home position
+    BT_CHASE,        // Walk toward the player at param times base speed
+    BT_LUNGE,        // Leap at the player at param times base speed
+    BT_FLEE,         // Run away from the player at param times base speed
+    BT_CLIMB         // Jump toward the player with upward velocity param
+};
+
+// Flat behavior tree node. Jump targets always point forward, so one ascending pass visits every node once
+struct BTNode {
+    BTOp op; // Node opcode
+    uint8_t onSuccess; // Next node when a condition passes
+    uint8_t onFailure; // Next node when a condition fails
+    float param; // Opcode parameter (distance, fraction, speed factor or jump force)
+};
+
+// Behavior tree stored as a flat node array, built as a selector of condition sequences
+class BehaviorTree {
+public:
+    std::vector<BTNode> nodes; // Nodes in evaluation order
+
+    // Appends a branch that runs the action when every condition passes, otherwise falls through to the next branch
+    void addBranch(std::initializer_list<std::pair<BTOp, float>> conditions, BTOp action, float actionParam);
+};
+
+// Tree for fast attackers: flee when hurt, lunge when close, climb toward the player, chase, else patrol
+BehaviorTree makeStalkerTree();
+
+// Tree for slow tanks: climb toward the player, chase when in range, else patrol
+BehaviorTree makeBruteTree();
+
+// Per-zombie blackboards in SoA form, evaluated in batches of agents sitting on the same tree node.
+// Nearby zombies of one profile are grouped into squads: only leaders sense and run their tree,
+// members copy the leader's decision and steer to hold their offset from it
+class ZombieBrains {
+public:
+    // Sensed inputs, written by the game before evaluate()
+    std::vector<float> posX; // Zombie x position
+    std::vector<float> posY; // Zombie y position
+    std::vector<float> healthFrac; // Health as a fraction of maximum
+    std::vector<uint8_t> onGround; // Whether the zombie stands on a platform
+    std::vector<uint8_t> wallAhead; // Whether terrain blocks the facing direction
+    std::vector<int32_t> cellX, cellY; // Tile cell the zombie's feet are in
+
+    // Persistent blackboard state
+    std::vector<uint8_t> archetype; // AI profile (tree index) for each slot
+    std::vector<uint8_t> alive; // Whether the slot is in use
+    std::vector<float> speed; // Base walking speed
+    std::vector<float> homeX; // Patrol anchor
+    std::vector<int8_t> facing; // -1 left, 1 right
+    std::vector<double> lungeReadyAt; // Time when the next lunge is allowed
+    std::vector<uint32_t> generation; // Bumped each time the slot is allocated, so stale leader links can be spotted
+    std::vector<int32_t> leader; // Squad leader slot, or -1 when leading (or alone)
+    std::vector<uint32_t> leaderGeneration; // Leader's generation when the squad was formed
+    std::vector<float> squadOffsetX; // Position relative to the leader the member keeps
+
+    // Outputs, read by the game after evaluate()
+    std::vector<float> moveX; // Desired horizontal velocity
+    std::vector<float> jumpVel; // Upward velocity to apply if grounded (0 for none)
+    std::vector<uint8_t> action; // Action opcode chosen this tick
+
+    // Constructor registering the default stalker and brute trees
+    ZombieBrains();
+
+    // Registers a named tree (AI profile) and returns its index
+    int addTree(const std::string& name, const BehaviorTree& tree);
+
+    // Index of the named AI profile, or -1 if unknown
+    int findTree(const std::string& name) const;
+
+    // Reserves room for count slots, so allocating up to that many does not touch the heap
+    void reserve(size_t count);
+
+    // Allocates a blackboard slot for a new zombie running the given AI profile
+    int allocate(int profile, float x, float baseSpeed);
+
+    // Frees a blackboard slot
+    void release(int slot);
+
+    // Uses a jump table for BT_JUMP_REACHES (without one the condition always passes)
+    void setJumpTable(const JumpTable* table);
+
+    // Distinct jump forces the registered trees test with BT_JUMP_REACHES, for building the jump table
+    std::vector<float> jumpForces() const;
+
+    // Regroups slots into squads. slots must be live slots of one AI profile in spatial order, with positions sensed
+    // (the last tick's will do): each run of slots within SQUAD_RADIUS of the first becomes a squad of up to MAX_SQUAD
+    // led by that first slot. Call it before the tick's senses, which skip followers, so new leaders sense that tick
+    void formSquads(std::span<const int> slots);
+
+    // Whether a slot follows a live squad leader this tick (and so needs no perception of its own)
+    bool isFollower(int slot) const {
+        int l = leader[slot];
+        return l >= 0 && alive[l] && generation[l] == leaderGeneration[slot];
+    }
+
+    // Runs every tree over all leaders and lone slots, then steers squad members after their leaders
+    void evaluate(float playerX, float playerY, double currentTime);
+
+    // Blackboard slots in use or free for reuse
+    size_t slotCount() const { return alive.size(); }
+
+    // Heap bytes held by blackboards, trees and scratch lists
+    size_t memoryBytes() const;
+
+private:
+    std::vector<BehaviorTree> trees; // Trees indexed by AI profile
+    std::vector<std::string> treeNames; // AI profile name of each tree
+    std::vector<int> freeSlots; // Released slots for reuse
+    std::vector<std::vector<uint32_t>> buckets; // Scratch lists of slots waiting at each node
+    std::vector<uint8_t> mask; // Scratch condition results for one bucket
+    const JumpTable* jumps; // Landing table for jump checks, or nullptr
+};
+
+#endif
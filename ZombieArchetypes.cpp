@@ -0,0 +1,151 @@
+#include "ZombieArchetypes.h"
+#include "ZombieAI.h"
+#include "utils.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// Parses a drop list such as "food:0.5" or "food:0.3,food:0.2" into entries
+static bool parseDrops(const std::string& text, std::vector<DropEntry>& out) {
+    if (text == "-") return true; // No drops
+    std::stringstream list(text);
+    std::string item;
+    while (std::getline(list, item, ',')) {
+        size_t colon = item.find(':');
+        if (colon == std::string::npos) return false;
+        std::string name = item.substr(0, colon);
+        const char* number = item.c_str() + colon + 1;
+        char* end = nullptr;
+        float chance = std::strtof(number, &end);
+        if (end == number) return false;
+        if (name == "food") {
+            out.push_back({DROP_FOOD, chance});
+        } else {
+            std::cerr << "Unknown drop item: " << name << "\n"; // Log and skip unknown items
+        }
+    }
+    return true;
+}
+
+// Parses the archetype file: one archetype per line, '#' starts a comment
+// Columns: name speed damage health width height sprite ai_profile spawn_weight drops [heavy]
+bool ArchetypeRegistry::load(const std::string& path, const ZombieBrains& brains) {
+    std::ifstream inFile(path);
+    if (!inFile.is_open()) {
+        std::cerr << "Failed to open zombie archetype file: " << path << "\n";
+        return false;
+    }
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(inFile, line)) {
+        lineNumber++;
+        size_t hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::istringstream fields(line);
+        std::string name, sprite, profile, dropText;
+        float spd, weight;
+        int dmg, hp, w, h;
+        if (!(fields >> name)) continue; // Blank line
+        if (!(fields >> spd >> dmg >> hp >> w >> h >> sprite >> profile >> weight >> dropText)) {
+            std::cerr << path << ":" << lineNumber << ": malformed archetype line\n";
+            return false;
+        }
+        int heavyFlag = 0;
+        if (!(fields >> heavyFlag)) heavyFlag = 0; // Optional column
+        int ai = brains.findTree(profile);
+        if (ai < 0) {
+            std::cerr << path << ":" << lineNumber << ": unknown AI profile " << profile << "\n";
+            return false;
+        }
+        std::vector<DropEntry> entries;
+        if (!parseDrops(dropText, entries)) {
+            std::cerr << path << ":" << lineNumber << ": malformed drop list " << dropText << "\n";
+            return false;
+        }
+        names.push_back(name);
+        speed.push_back(spd);
+        damage.push_back(dmg);
+        health.push_back(hp);
+        width.push_back(w);
+        height.push_back(h);
+        aiProfile.push_back(ai);
+        spritePaths.push_back(sprite);
+        textures.push_back(nullptr);
+        spawnWeight.push_back(weight);
+        heavy.push_back(heavyFlag != 0);
+        dropBegin.push_back(static_cast<int>(drops.size()));
+        drops.insert(drops.end(), entries.begin(), entries.end());
+        dropEnd.push_back(static_cast<int>(drops.size()));
+    }
+    float total = 0.0f;
+    for (float weight : spawnWeight) {
+        total += weight;
+        spawnCumulative.push_back(total);
+    }
+    if (names.empty() || total <= 0.0f) {
+        std::cerr << "No spawnable zombie archetypes in " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+// Number of archetypes
+int ArchetypeRegistry::count() const {
+    return static_cast<int>(names.size());
+}
+
+// ID of the named archetype, or -1 if unknown
+int ArchetypeRegistry::find(const std::string& name) const {
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+// Picks an archetype ID by spawn weight
+int ArchetypeRegistry::pickRandom(std::mt19937& gen) const {
+    std::uniform_real_distribution<float> dist(0.0f, spawnCumulative.back());
+    size_t i = std::upper_bound(spawnCumulative.begin(), spawnCumulative.end(), dist(gen)) - spawnCumulative.begin();
+    return static_cast<int>(std::min(i, spawnCumulative.size() - 1));
+}
+
+// Rolls the archetype's drop table; returns a DropItem or -1 for nothing
+int ArchetypeRegistry::rollDrop(int id, std::mt19937& gen) const {
+    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    float roll = dist(gen);
+    for (int i = dropBegin[id]; i < dropEnd[id]; i++) {
+        if (roll < drops[i].chance) return drops[i].item;
+        roll -= drops[i].chance;
+    }
+    return -1;
+}
+
+// Largest collision width over all archetypes
+int ArchetypeRegistry::maxWidth() const {
+    return width.empty() ? 0 : *std::max_element(width.begin(), width.end());
+}
+
+// Largest collision height over all archetypes
+int ArchetypeRegistry::maxHeight() const {
+    return height.empty() ? 0 : *std::max_element(height.begin(), height.end());
+}
+
+// Loads every archetype's sprite; returns false if any is missing
+bool ArchetypeRegistry::loadTextures(SDL_Renderer* renderer) {
+    bool ok = true;
+    for (size_t i = 0; i < spritePaths.size(); i++) {
+        textures[i] = loadTexture(spritePaths[i], renderer);
+        if (!textures[i]) ok = false;
+    }
+    return ok;
+}
+
+// Frees sprite textures
+void ArchetypeRegistry::destroyTextures() {
+    for (auto& tex : textures) {
+        if (tex) SDL_DestroyTexture(tex);
+        tex = nullptr;
+    }
+}
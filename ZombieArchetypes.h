@@ -0,0 +1,69 @@
+#ifndef ZOMBIEARCHETYPES_H
+#define ZOMBIEARCHETYPES_H
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+class ZombieBrains;
+
+// Items a zombie can drop on death
+enum DropItem { DROP_FOOD = 0 };
+
+// One entry of an archetype's drop table
+struct DropEntry {
+    int item; // DropItem to drop
+    float chance; // Probability of this entry (entries of one archetype add up to at most 1)
+};
+
+// Zombie archetypes loaded from a data file and compiled into dense tables indexed by archetype ID
+class ArchetypeRegistry {
+public:
+    // Dense per-archetype tables, read directly by spawning and the per-group update loops
+    std::vector<std::string> names; // Archetype name
+    std::vector<float> speed; // Movement speed
+    std::vector<int> damage; // Damage dealt to the player per hit
+    std::vector<int> health; // Starting health
+    std::vector<int> width; // Collision and sprite width
+    std::vector<int> height; // Collision and sprite height
+    std::vector<int> aiProfile; // Behavior tree index in ZombieBrains
+    std::vector<std::string> spritePaths; // Sprite image path
+    std::vector<SDL_Texture*> textures; // Loaded sprite
+    std::vector<float> spawnWeight; // Relative chance of being picked by random spawns
+    std::vector<uint8_t> heavy; // Whether the archetype breaks tiles when it lands hard
+    std::vector<int> dropBegin; // First entry of the archetype's drop table in drops
+    std::vector<int> dropEnd; // One past the last entry of the archetype's drop table
+    std::vector<DropEntry> drops; // Drop tables of all archetypes, back to back
+
+    // Parses the archetype file and compiles the tables; AI profile names are resolved against brains
+    bool load(const std::string& path, const ZombieBrains& brains);
+
+    // Number of archetypes
+    int count() const;
+
+    // ID of the named archetype, or -1 if unknown
+    int find(const std::string& name) const;
+
+    // Picks an archetype ID by spawn weight
+    int pickRandom(std::mt19937& gen) const;
+
+    // Rolls the archetype's drop table; returns a DropItem or -1 for nothing
+    int rollDrop(int id, std::mt19937& gen) const;
+
+    // Largest collision box over all archetypes
+    int maxWidth() const;
+    int maxHeight() const;
+
+    // Loads every archetype's sprite; returns false if any is missing
+    bool loadTextures(SDL_Renderer* renderer);
+
+    // Frees sprite textures
+    void destroyTextures();
+
+private:
+    std::vector<float> spawnCumulative; // Running total of spawn weights
+};
+
+#endif
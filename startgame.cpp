@@ -7,15 +7,41 @@
 #include <fstream>
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include "utils.h"
+#include "AllocTracker.h"
+#include "Profiler.h"
+#include "PerfCounters.h"
+#include "FrameTrace.h"
+#include "Metrics.h"
+#include "SharedState.h"
+#include "MapGen.h"
 
 // External function declaration for starting the main game
-extern int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win, SDL_Renderer* ren);
+extern int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win, SDL_Renderer* ren, const char* levelPath);
+
+// External function declaration for the headless memory scaling benchmark
+extern int RunMemoryBenchmark(const MapParams* mapParams);
+
+// External function declaration for the headless save/load benchmark
+extern int RunSaveBenchmark();
+
+// External function declaration for the headless micro-benchmarks
+extern int RunMicroBenchmarks(const char* savePath, const char* baselinePath, double threshold, bool allowNew, const MapParams* mapParams);
 
 // Screen dimensions and constants
 const int SCREEN_WIDTH = 800; // Width of the game window
 const int SCREEN_HEIGHT = 600; // Height of the game window
 const int MAX_NAME_LENGTH = 10; // Maximum length of player name
+const int PROFILE_HZ = 100; // Profiler samples per CPU second (--profile)
+const size_t PROFILE_SAMPLES = 20000; // Profiler ring size: the last 200 CPU seconds at PROFILE_HZ, about 5 MB
+const double SPIKE_BUDGET_MS = 50.0; // Frames slower than this are dumped (three frames at 60 FPS; --spike-ms)
+const int SPIKE_MAX_DUMPS = 5; // Spike files written per game at most
+const uint32_t SHARED_ZOMBIES = 1024; // Zombie records in the shared state segment (--shared-state)
+const uint32_t SHARED_FOOD = 256; // Food records in the shared state segment
+const double BENCH_THRESHOLD = 0.15; // Slowdown against the baseline that fails --bench-baseline (15%)
 
 // Function to render text to an SDL texture
 SDL_Texture* renderText(const std::string& message, SDL_Color& color, TTF_Font* font, SDL_Renderer* renderer, int wrapLength = 0) {
@@ -45,6 +71,69 @@ bool hasSavedGame() {
 }
 
 int main(int argc, char* argv[]) {
+    const char* levelPath = nullptr; // Optional baked level file; the built-in level otherwise
+    const char* metricsPath = nullptr; // Unix socket for the metrics endpoint; none by default
+    const char* sharedStateName = nullptr; // Shared memory object for live world state; none by default
+    bool memBench = false; // Run the memory scaling benchmark instead of the game
+    bool saveBench = false; // Run the save/load benchmark instead of the game
+    bool microBench = false; // Run the micro-benchmarks instead of the game
+    MapParams benchMap; // Generated map for the memory and micro-benchmarks (--bench-map)
+    bool useBenchMap = false; // Whether benchMap is used instead of the built-in level
+    const char* benchSavePath = nullptr; // Where to write a new baseline
+    const char* benchBaselinePath = nullptr; // Baseline to compare against
+    double benchThreshold = BENCH_THRESHOLD;
+    bool benchAllowNew = false; // Let benchmarks missing from the baseline pass
+    traceConfigure(SPIKE_BUDGET_MS, SPIKE_MAX_DUMPS);
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--mem-bench") == 0) {
+            memBench = true; // Peak RSS at 1k, 10k and 100k zombies; needs no window
+        } else if (std::strcmp(argv[i], "--save-bench") == 0) {
+            saveBench = true; // Save/load latency, file size and peak RSS from 10 to 1M zombies; needs no window
+        } else if (std::strncmp(argv[i], "--bench-map=", 12) == 0) {
+            // Seeded map for the benchmarks: <seed>,<cols>,<rows>[,<density>], the arguments mapgen takes
+            unsigned long long seed = 0;
+            int fields = std::sscanf(argv[i] + 12, "%llu,%d,%d,%f", &seed, &benchMap.cols, &benchMap.rows, &benchMap.density);
+            if (fields < 3) {
+                std::cerr << "--bench-map wants <seed>,<cols>,<rows>[,<density>]\n";
+                return 1;
+            }
+            benchMap.seed = seed;
+            useBenchMap = true;
+        } else if (std::strcmp(argv[i], "--micro-bench") == 0) {
+            microBench = true; // ns/op of hot helpers; needs no window
+        } else if (std::strncmp(argv[i], "--bench-save=", 13) == 0) {
+            benchSavePath = argv[i] + 13;
+        } else if (std::strncmp(argv[i], "--bench-baseline=", 17) == 0) {
+            benchBaselinePath = argv[i] + 17;
+        } else if (std::strncmp(argv[i], "--bench-threshold=", 18) == 0) {
+            benchThreshold = std::atof(argv[i] + 18) / 100.0; // Percent
+        } else if (std::strcmp(argv[i], "--bench-allow-new") == 0) {
+            benchAllowNew = true; // For a new benchmark, until the baseline is recorded again
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            profilerStart(PROFILE_HZ, PROFILE_SAMPLES); // Sampled stacks go to profile.folded on exit
+        } else if (std::strcmp(argv[i], "--perf-counters") == 0) {
+            // Hardware counters per frame phase, reported when a game ends
+            if (!perfOpen()) std::cerr << "Hardware counters unavailable; frame phases are timed only (the report says why)\n";
+        } else if (std::strncmp(argv[i], "--spike-ms=", 11) == 0) {
+            traceConfigure(std::atof(argv[i] + 11), SPIKE_MAX_DUMPS); // Frame budget for spike dumps; 0 turns them off
+        } else if (std::strncmp(argv[i], "--metrics-socket=", 17) == 0) {
+            metricsPath = argv[i] + 17; // Prometheus text on a Unix socket, served from a background thread
+        } else if (std::strncmp(argv[i], "--shared-state=", 15) == 0) {
+            sharedStateName = argv[i] + 15; // Live world state for external tools
+        } else if (std::strcmp(argv[i], "--alloc-test") == 0) {
+            // Stop with an error at the first heap allocation in steady-state gameplay
+            if (!allocTrackingEnabled()) std::cerr << "--alloc-test needs a build with allocation tracking (make tgame4-alloc)\n";
+            allocSetStrict(true);
+        } else if (!levelPath) {
+            levelPath = argv[i];
+        }
+    }
+
+    const MapParams* mapParams = useBenchMap ? &benchMap : nullptr; // The built-in level otherwise
+    if (memBench) return RunMemoryBenchmark(mapParams);
+    if (saveBench) return RunSaveBenchmark(); // Saves hold no terrain, so the map does not matter
+    if (microBench) return RunMicroBenchmarks(benchSavePath, benchBaselinePath, benchThreshold, benchAllowNew, mapParams); // Fails on a regression or a gap
+
     // Initialize SDL, SDL_ttf, and SDL_image
     if (SDL_Init(SDL_INIT_VIDEO) != 0 || TTF_Init() != 0 || !(IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG)) {
         std::cerr << "Init failed: " << SDL_GetError() << std::endl; // Log initialization error
@@ -108,6 +197,10 @@ int main(int argc, char* argv[]) {
         return 1; // Exit with error code
     }
 
+    // Started once nothing can fail: every exit below stops them
+    if (metricsPath) metricsStart(metricsPath);
+    if (sharedStateName) sharedStateOpen(sharedStateName, SHARED_ZOMBIES, SHARED_FOOD);
+
     // Define rectangles for menu buttons
     SDL_Rect startRect = {300, 250, 200, 50}; // Start game button
     SDL_Rect continueRect = {300, 330, 200, 50}; // Continue game button
@@ -200,7 +293,11 @@ int main(int argc, char* argv[]) {
                         nameTexture = nullptr;
                     }
                     // Run the main game with saved state
-                    int exitStatus = RunMainGame(playerName, true, window, renderer);
+                    int exitStatus = RunMainGame(playerName, true, window, renderer, levelPath);
+                    if (allocStrict() && allocViolation()) { // --alloc-test failed: exit now instead of back to the menu
+                        running = false;
+                        break;
+                    }
                     SDL_StartTextInput(); // Re-enable text input
                     screenState = MENU; // Return to main menu
                     isGameOver = (exitStatus == 0); // Update game over status
@@ -229,7 +326,11 @@ int main(int argc, char* argv[]) {
                         nameTexture = nullptr;
                     }
                     // Run the main game with new game state
-                    int exitStatus = RunMainGame(playerName, false, window, renderer);
+                    int exitStatus = RunMainGame(playerName, false, window, renderer, levelPath);
+                    if (allocStrict() && allocViolation()) { // --alloc-test failed: exit now instead of back to the menu
+                        running = false;
+                        break;
+                    }
                     SDL_StartTextInput(); // Re-enable text input
                     screenState = MENU; // Return to main menu
                     isGameOver = (exitStatus == 0); // Update game over status
@@ -237,6 +338,7 @@ int main(int argc, char* argv[]) {
                 }
             }
         }
+        if (!running) break; // Quit, or a failed allocation test: skip drawing the menu again
 
         // Check for invalid window or renderer
         if (!window || !renderer) {
@@ -338,6 +440,10 @@ int main(int argc, char* argv[]) {
         SDL_Delay(16); // Cap frame rate to ~60 FPS
     }
 
+    if (profilerRunning()) profilerWrite("profile.folded"); // Folded stacks for flamegraph.pl
+    metricsStop(); // Removes the socket file
+    sharedStateClose(); // Removes the shared memory object
+
     // Cleanup resources
     if (nameTexture) SDL_DestroyTexture(nameTexture); // Destroy name texture
     SDL_DestroyTexture(background); SDL_DestroyTexture(titleText); // Destroy menu textures
@@ -347,5 +453,5 @@ int main(int argc, char* argv[]) {
     TTF_CloseFont(font); TTF_CloseFont(titleFont); // Close fonts
     SDL_DestroyRenderer(renderer); SDL_DestroyWindow(window); // Destroy renderer and window
     TTF_Quit(); IMG_Quit(); SDL_Quit(); // Cleanup SDL subsystems
-    return 0; // Exit program
+    return allocViolation() ? 1 : 0; // Exit program, failing the allocation test if gameplay allocated
 }
\ No newline at end of file
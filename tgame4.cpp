@@ -8,8 +8,35 @@
 #include <SDL2/SDL2_gfxPrimitives.h>
 #include <random>
 #include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <type_traits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "utils.h"
 #include "Weather.h"
+#include "ZombieAI.h"
+#include "WaveDirector.h"
+#include "SpawnScheduler.h"
+#include "ZombieArchetypes.h"
+#include "Level.h"
+#include "MapGen.h"
+#include "Terrain.h"
+#include "TerrainCache.h"
+#include "SpatialSort.h"
+#include "JumpTable.h"
+#include "FrameArena.h"
+#include "AllocTracker.h"
+#include "MemoryReport.h"
+#include "PerfCounters.h"
+#include "FrameTrace.h"
+#include "Metrics.h"
+#include "SharedState.h"
+#include "Bench.h"
 
 // Screen and game constants
 const int SCREEN_WIDTH = 800; // Width of the game window
@@ -24,6 +51,32 @@ const float PLAYER_ACCEL = 0.8f; // Player acceleration rate
 const float FRICTION = 0.7f; // Friction to slow down movement
 const float MAX_SPEED = 5.0f; // Maximum horizontal speed for entities
 
+// Built-in level, baked into the binary at compile time
+constexpr int DEFAULT_COLS = (SCREEN_WIDTH + TILE_SIZE - 1) / TILE_SIZE; // Tile columns covering the screen
+constexpr int DEFAULT_ROWS = (SCREEN_HEIGHT + TILE_SIZE - 1) / TILE_SIZE; // Tile rows covering the screen
+constexpr int DEFAULT_SPAWN_BOX = 32; // Zombie collision box the spawn surfaces are baked for
+constexpr SDL_Rect DEFAULT_SPAWN_BOUNDS = {10, 0, SCREEN_WIDTH - 40, SCREEN_HEIGHT}; // Same x range the zombie update clamps to
+constexpr int DEFAULT_GROUND_ROW = 17; // Top row of the ground, which cannot be destroyed
+constexpr Platform DEFAULT_PLATFORMS[] = {
+    {0, 17, 25, 2}, // Ground level
+    {2, 12, 8, 1}, // Platform 1
+    {15, 12, 8, 1}, // Platform 2
+    {10, 8, 5, 1}, // Platform 3
+    {2, 4, 8, 1}, // Platform 4
+    {15, 4, 8, 1} // Platform 5
+};
+static_assert(!platformsOverlap(DEFAULT_PLATFORMS), "Default level platforms overlap");
+static_assert(platformsInside(DEFAULT_PLATFORMS, DEFAULT_COLS, DEFAULT_ROWS), "Default level platform outside SCREEN_WIDTH x SCREEN_HEIGHT");
+constexpr auto DEFAULT_PLATFORM_RECTS = platformPixelRects(DEFAULT_PLATFORMS, TILE_SIZE); // Pixel rect of each platform
+constexpr auto DEFAULT_SOLID_BITS = solidBitset<DEFAULT_COLS, DEFAULT_ROWS>(DEFAULT_PLATFORMS); // Collision bitset
+constexpr size_t DEFAULT_SPAWN_COUNT = countSpawnSurfaces(DEFAULT_PLATFORM_RECTS, DEFAULT_SPAWN_BOX, DEFAULT_SPAWN_BOX, DEFAULT_SPAWN_BOUNDS);
+constexpr auto DEFAULT_SPAWN_SURFACES = spawnSurfaceTable<DEFAULT_SPAWN_COUNT>(DEFAULT_PLATFORM_RECTS, DEFAULT_SPAWN_BOX, DEFAULT_SPAWN_BOX, DEFAULT_SPAWN_BOUNDS);
+static_assert(DEFAULT_SPAWN_COUNT > 0, "Default level has nowhere to spawn zombies");
+constexpr MoverPath DEFAULT_MOVERS[] = {
+    {352, 528, 352, 384, 96, 16, 1.0f} // Elevator from the ground up to the height of platforms 1 and 2
+};
+static_assert(moversInside(DEFAULT_MOVERS, SCREEN_WIDTH, SCREEN_HEIGHT), "Default level moving platform leaves the screen");
+
 // Vector2D structure for 2D position and velocity
 struct Vector2D {
     float x, y; // X and Y coordinates
@@ -33,31 +86,6 @@ struct Vector2D {
     void set(float x_, float y_) { x = x_; y = y_; } // Set vector components
 };
 
-// Platform structure to represent static platforms
-struct Platform {
-    int x, y, width, height; // Position and dimensions in tile units
-    SDL_Texture* texture; // Texture for rendering the platform
-};
-
-// Terrain class to manage collision detection with platforms
-class Terrain {
-public:
-    std::vector<Platform> platforms; // List of platforms
-    Terrain(const std::vector<Platform>& plats) : platforms(plats) {} // Constructor initializing platforms
-
-    // Check if a point is solid (within a platform)
-    bool getSolid(int x, int y) {
-        for (const auto& platform : platforms) {
-            SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-            if (x >= platformRect.x && x < platformRect.x + platformRect.w &&
-                y >= platformRect.y && y < platformRect.y + platformRect.h) {
-                return true; // Point is within a platform
-            }
-        }
-        return false; // Point is not within any platform
-    }
-};
-
 // Base class for entities with physics (player, zombies, food)
 class PhysicsEntity {
 public:
@@ -73,11 +101,27 @@ public:
     bool friction; // Whether friction is applied
     int health; // Entity health
     int lastDirection; // Last movement direction for rendering
+    int support; // Moving platform the entity stands on, or -1
+
+    // Terrain contacts from earlier ticks, checked before querying the terrain again
+    struct SupportContact {
+        bool valid; // Whether a support surface is cached
+        float top; // Surface top y
+        float left, right; // Pixel extent of the run of exposed tiles
+        unsigned revision; // Terrain revision the contact was found in
+    } supportCache;
+    struct WallContact {
+        bool valid; // Whether a wall is cached
+        float x; // Snap x the wall puts the entity at
+        int rowTop, rowBottom; // Tile rows the entity spanned when the wall was hit
+        unsigned revision; // Terrain revision the contact was found in
+    } leftWallCache, rightWallCache;
 
     // Constructor initializing position, size, and textures
     PhysicsEntity(float x, float y, int w_, int h_, SDL_Texture* runTex[], SDL_Texture* standTex[])
         : pos(x, y), vel(0, 0), w(w_), h(h_), curFrame(0), frameTime(0.0f), frameSpeed(0.08f),
-          onGround(false), gravity(true), friction(true), health(100), lastDirection(1) {
+          onGround(false), gravity(true), friction(true), health(100), lastDirection(1), support(-1),
+          supportCache{}, leftWallCache{}, rightWallCache{} {
         col.set(w_, h_); // Set collision box to match size
         for (int i = 0; i < 10; i++) {
             runTextures[i] = runTex[i]; // Copy run animation textures
@@ -87,11 +131,20 @@ public:
         }
     }
 
-    // Virtual destructor for proper cleanup in derived classes
-    virtual ~PhysicsEntity() {}
+    // Constructor for entities drawn with a single texture (zombies, food)
+    PhysicsEntity(float x, float y, int w_, int h_, SDL_Texture* tex)
+        : pos(x, y), vel(0, 0), w(w_), h(h_), curFrame(0), frameTime(0.0f), frameSpeed(0.08f),
+          onGround(false), gravity(true), friction(true), health(100), lastDirection(1), support(-1),
+          supportCache{}, leftWallCache{}, rightWallCache{} {
+        col.set(w_, h_); // Set collision box to match size
+        for (int i = 0; i < 10; i++) runTextures[i] = nullptr;
+        for (int i = 0; i < 12; i++) standTextures[i] = nullptr;
+        runTextures[0] = tex;
+        standTextures[0] = tex;
+    }
 
     // Render the entity based on movement state
-    virtual void render(SDL_Renderer* renderer, bool isMovingRight, bool isMovingLeft) {
+    void render(SDL_Renderer* renderer, bool isMovingRight, bool isMovingLeft) {
         SDL_Rect dst = {static_cast<int>(pos.x), static_cast<int>(pos.y), w, h}; // Destination rectangle
         SDL_RendererFlip flip = SDL_FLIP_NONE; // Default no flip
         if (isMovingLeft && runTextures[0]) {
@@ -112,59 +165,12 @@ public:
     }
 
     // Update entity position, velocity, and collisions
-    virtual void update(Terrain* terrain, bool hasInput, bool isMovingRight, bool isMovingLeft) {
+    void update(Terrain* terrain, bool hasInput, bool isMovingRight, bool isMovingLeft) {
         if (gravity) vel.y += GRAVITY; // Apply gravity
         if (onGround && friction && !hasInput) vel.x *= FRICTION; // Apply friction if no input
         pos.add(vel); // Update position based on velocity
 
-        onGround = false; // Reset ground state
-        if (grounded(terrain) && vel.y >= 0) { // Check if entity is on ground
-            vel.y = 0; // Stop vertical movement
-            onGround = true;
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.x + w > platformRect.x && pos.x < platformRect.x + platformRect.w &&
-                    pos.y + h >= platformRect.y && pos.y + h <= platformRect.y + 10) {
-                    pos.y = platformRect.y - h; // Snap to platform top
-                    break;
-                }
-            }
-        }
-
-        if (ceilingCol(terrain) && vel.y < 0) { // Check for ceiling collision
-            vel.y = 0; // Stop upward movement
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.x + w > platformRect.x && pos.x < platformRect.x + platformRect.w &&
-                    pos.y <= platformRect.y + platformRect.h && pos.y >= platformRect.y) {
-                    pos.y = platformRect.y + platformRect.h; // Snap to platform bottom
-                    break;
-                }
-            }
-        }
-
-        if (leftCol(terrain) && vel.x < 0 && !ceilingCol(terrain)) { // Check for left wall collision
-            vel.x = 0; // Stop leftward movement
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.y + h > platformRect.y && pos.y < platformRect.y + platformRect.h &&
-                    pos.x <= platformRect.x + platformRect.w && pos.x >= platformRect.x) {
-                    pos.x = platformRect.x + platformRect.w; // Snap to right side of platform
-                    break;
-                }
-            }
-        }
-        if (rightCol(terrain) && vel.x > 0 && !ceilingCol(terrain)) { // Check for right wall collision
-            vel.x = 0; // Stop rightward movement
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.y + h > platformRect.y && pos.y < platformRect.y + platformRect.h &&
-                    pos.x + w >= platformRect.x && pos.x + w <= platformRect.x + platformRect.w) {
-                    pos.x = platformRect.x - w; // Snap to left side of platform
-                    break;
-                }
-            }
-        }
+        collideTerrain(terrain); // Resolve platform collisions
 
         // Keep entity within screen bounds
         if (pos.x <= 10) { pos.x = 10; vel.x = 10; }
@@ -185,6 +191,98 @@ public:
         }
     }
 
+    // Snap against platforms after moving: ride moving platforms, land on tops, bump ceilings, stop at walls.
+    // Tiles are snapped to through the grid, so the cost stays the same when tiles are destroyed. Contacts from the
+    // last tick are tried first: a body still standing on (or pushing into) the same surface needs only a bounds check
+    void collideTerrain(Terrain* terrain) {
+        if (support >= 0) { // Carried along by the moving platform stood on last tick
+            pos.x += terrain->movers[support].dx;
+            pos.y += terrain->movers[support].dy;
+        }
+        support = -1;
+        onGround = false; // Reset ground state
+        unsigned revision = terrain->getRevision();
+        float edge; // Snap coordinate found in the tile grid
+        float feetY = pos.y + h;
+        const SupportContact& sc = supportCache;
+        if (vel.y >= 0 && sc.valid && sc.revision == revision && feetY >= sc.top && feetY <= sc.top + 10 &&
+            ((pos.x + 1 >= sc.left && pos.x + 1 < sc.right) || (pos.x + col.x - 1 >= sc.left && pos.x + col.x - 1 < sc.right))) {
+            vel.y = 0; // Still on the cached surface
+            onGround = true;
+            pos.y = sc.top - h;
+        } else if (grounded(terrain) && vel.y >= 0) { // Check if entity is on ground
+            supportCache.valid = false;
+            vel.y = 0; // Stop vertical movement
+            onGround = true;
+            if (terrain->floorTop(pos.x, pos.x + w, feetY, 10.0f, edge, supportCache.left, supportCache.right)) {
+                pos.y = edge - h; // Snap to platform top
+                supportCache.top = edge;
+                supportCache.revision = revision;
+                supportCache.valid = true;
+            } else {
+                support = terrain->findMover([&](const SDL_Rect& r) {
+                    return pos.x + w > r.x && pos.x < r.x + r.w && pos.y + h >= r.y && pos.y + h <= r.y + 10;
+                });
+                if (support >= 0) pos.y = terrain->movers[support].rect.y - h; // Snap to moving platform top
+            }
+        } else {
+            supportCache.valid = false;
+        }
+
+        if (vel.y < 0 && ceilingCol(terrain)) { // Check for ceiling collision
+            vel.y = 0; // Stop upward movement
+            if (terrain->ceilingBottom(pos.x, pos.x + w, pos.y, edge)) {
+                pos.y = edge; // Snap to platform bottom
+            } else {
+                int mover = terrain->findMover([&](const SDL_Rect& r) {
+                    return pos.x + w > r.x && pos.x < r.x + r.w && pos.y <= r.y + r.h && pos.y >= r.y;
+                });
+                if (mover >= 0) pos.y = terrain->movers[mover].rect.y + terrain->movers[mover].rect.h;
+            }
+        }
+
+        const WallContact& lw = leftWallCache;
+        if (vel.x < 0 && lw.valid && lw.revision == revision && lw.rowTop == rowTop() && lw.rowBottom == rowBottom() &&
+            pos.x <= lw.x && pos.x > lw.x - TILE_SIZE && !ceilingCol(terrain)) { // Same conditions as the full check below
+            vel.x = 0; // Still pushing into the cached wall
+            pos.x = lw.x;
+        } else if (leftCol(terrain) && vel.x < 0 && !ceilingCol(terrain)) { // Check for left wall collision
+            leftWallCache.valid = false;
+            vel.x = 0; // Stop leftward movement
+            if (terrain->wallRightEdge(pos.x, pos.y, pos.y + h, edge)) {
+                pos.x = edge; // Snap to right side of platform
+                leftWallCache = {true, edge, rowTop(), rowBottom(), revision};
+            } else {
+                int mover = terrain->findMover([&](const SDL_Rect& r) {
+                    return pos.y + h > r.y && pos.y < r.y + r.h && pos.x <= r.x + r.w && pos.x >= r.x;
+                });
+                if (mover >= 0) pos.x = terrain->movers[mover].rect.x + terrain->movers[mover].rect.w;
+            }
+        } else if (vel.x < 0) {
+            leftWallCache.valid = false;
+        }
+        const WallContact& rw = rightWallCache;
+        if (vel.x > 0 && rw.valid && rw.revision == revision && rw.rowTop == rowTop() && rw.rowBottom == rowBottom() &&
+            pos.x >= rw.x && pos.x < rw.x + TILE_SIZE && !ceilingCol(terrain)) { // Same conditions as the full check below
+            vel.x = 0; // Still pushing into the cached wall
+            pos.x = rw.x;
+        } else if (rightCol(terrain) && vel.x > 0 && !ceilingCol(terrain)) { // Check for right wall collision
+            rightWallCache.valid = false;
+            vel.x = 0; // Stop rightward movement
+            if (terrain->wallLeftEdge(pos.x + w, pos.y, pos.y + h, edge)) {
+                pos.x = edge - w; // Snap to left side of platform
+                rightWallCache = {true, edge - w, rowTop(), rowBottom(), revision};
+            } else {
+                int mover = terrain->findMover([&](const SDL_Rect& r) {
+                    return pos.y + h > r.y && pos.y < r.y + r.h && pos.x + w >= r.x && pos.x + w <= r.x + r.w;
+                });
+                if (mover >= 0) pos.x = terrain->movers[mover].rect.x - w;
+            }
+        } else if (vel.x > 0) {
+            rightWallCache.valid = false;
+        }
+    }
+
     // Apply acceleration to velocity
     void accelerate(float x, float y) {
         vel.x += x;
@@ -210,6 +308,10 @@ public:
                terrain->getSolid((int)(pos.x + 1), (int)(pos.y));
     }
 
+    // First and last tile row the entity spans, as the wall queries see them
+    int rowTop() const { return static_cast<int>(std::floor(pos.y / TILE_SIZE)); }
+    int rowBottom() const { return static_cast<int>(std::ceil((pos.y + h) / TILE_SIZE)) - 1; }
+
     // Check for left wall collision
     bool leftCol(Terrain* terrain) {
         if (vel.x >= 0) return false;
@@ -231,82 +333,46 @@ public:
 // Zombie class, inherits from PhysicsEntity
 class Zombie : public PhysicsEntity {
 public:
-    enum Type { ATTACK, TANK }; // Zombie types: fast attacker or slow tank
-    Type type; // Current zombie type
-    float speed; // Movement speed
-    int damage; // Damage dealt to player
+    int archetype; // Archetype ID in the ArchetypeRegistry
     double lastDamageTime; // Time of last damage dealt
+    int brain; // Blackboard slot in ZombieBrains (-1 if none)
+    uint32_t handle; // Stable ID in the horde's handle table
+    uint32_t sortKey; // Morton key of its cell at the last spatial sort (UNSORTED_KEY before the first)
+
+    // Constructor initializing zombie with position, size, texture, archetype, and starting health
+    Zombie(float x, float y, int w_, int h_, SDL_Texture* tex, int archetypeId, int startHealth)
+        : PhysicsEntity(x, y, w_, h_, tex), archetype(archetypeId), lastDamageTime(0.0), brain(-1), handle(0), sortKey(UNSORTED_KEY) {
+        health = startHealth;
+    }
 
-    // Constructor initializing zombie with position, size, texture, and type
-    Zombie(float x, float y, int w_, int h_, SDL_Texture* tex, Type t)
-    : PhysicsEntity(x, y, w_, h_, new SDL_Texture*[10]{tex, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr},
-                               new SDL_Texture*[12]{tex, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr}),
-      type(t), lastDamageTime(0.0) {
-    speed = (type == ATTACK) ? 2.0f : 0.5f; // Set speed based on type
-    damage = (type == ATTACK) ? 5 : 10; // Set damage based on type
-    health = (type == ATTACK) ? 50 : 100; // Set health based on type
-    }
-
-    // Update zombie to chase player and handle physics
-    void update(Terrain* terrain, const PhysicsEntity& player, bool isMovingRight, bool isMovingLeft) {
-        float dx = player.pos.x - pos.x; // Distance to player
-        if (std::abs(dx) > 5.0f) {
-            vel.x = (dx > 0 ? speed : -speed); // Move toward player
-        } else {
-            vel.x = 0; // Stop if close to player
+    // Write this zombie's senses into its blackboard slot before AI evaluation
+    void sense(Terrain* terrain, ZombieBrains& brains, float maxHealth) const {
+        if (brain < 0) return;
+        brains.posX[brain] = pos.x;
+        brains.posY[brain] = pos.y;
+        brains.healthFrac[brain] = health / maxHealth;
+        brains.onGround[brain] = onGround;
+        if (brains.isFollower(brain)) return; // Squad members act on their leader's perception
+        brains.cellX[brain] = static_cast<int>(std::floor((pos.x + w / 2.0f) / TILE_SIZE));
+        brains.cellY[brain] = static_cast<int>(std::floor((pos.y + h - 1) / TILE_SIZE));
+        int probeX = brains.facing[brain] > 0 ? static_cast<int>(pos.x + col.x + 2) : static_cast<int>(pos.x - 2); // Just past the facing side
+        brains.wallAhead[brain] = terrain->getSolid(probeX, static_cast<int>(pos.y + col.y / 2));
+    }
+
+    // Update zombie from its AI decision and handle physics
+    void update(Terrain* terrain, const ZombieBrains& brains) {
+        if (brain >= 0) {
+            vel.x = brains.moveX[brain]; // Move as the behavior tree decided
+            if (onGround && brains.jumpVel[brain] < 0) {
+                vel.y = brains.jumpVel[brain]; // Jump, lunge or climb
+                onGround = false;
+            }
         }
         if (gravity) vel.y += GRAVITY; // Apply gravity
         if (onGround && friction && !vel.x) vel.x *= FRICTION; // Apply friction
         pos.add(vel); // Update position
 
-        onGround = false; // Reset ground state
-        if (grounded(terrain) && vel.y >= 0) { // Check if on ground
-            vel.y = 0;
-            onGround = true;
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.x + w > platformRect.x && pos.x < platformRect.x + platformRect.w &&
-                    pos.y + h >= platformRect.y && pos.y + h <= platformRect.y + 10) {
-                    pos.y = platformRect.y - h; // Snap to platform top
-                    break;
-                }
-            }
-        }
-
-        if (ceilingCol(terrain) && vel.y < 0) { // Check for ceiling collision
-            vel.y = 0;
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.x + w > platformRect.x && pos.x < platformRect.x + platformRect.w &&
-                    pos.y <= platformRect.y + platformRect.h && pos.y >= platformRect.y) {
-                    pos.y = platformRect.y + platformRect.h; // Snap to platform bottom
-                    break;
-                }
-            }
-        }
-
-        if (leftCol(terrain) && vel.x < 0 && !ceilingCol(terrain)) { // Check for left wall collision
-            vel.x = 0;
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.y + h > platformRect.y && pos.y < platformRect.y + platformRect.h &&
-                    pos.x <= platformRect.x + platformRect.w && pos.x >= platformRect.x) {
-                    pos.x = platformRect.x + platformRect.w; // Snap to right side
-                    break;
-                }
-            }
-        }
-        if (rightCol(terrain) && vel.x > 0 && !ceilingCol(terrain)) { // Check for right wall collision
-            vel.x = 0;
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.y + h > platformRect.y && pos.y < platformRect.y + platformRect.h &&
-                    pos.x + w >= platformRect.x && pos.x + w <= platformRect.x + platformRect.w) {
-                    pos.x = platformRect.x - w; // Snap to left side
-                    break;
-                }
-            }
-        }
+        collideTerrain(terrain); // Resolve platform collisions
 
         // Keep zombie within screen bounds
         if (pos.x <= 10) { pos.x = 10; vel.x = 10; }
@@ -315,19 +381,11 @@ public:
         else if (pos.y >= SCREEN_HEIGHT -h -50 ) { pos.y = SCREEN_HEIGHT -h -50; vel.y = SCREEN_HEIGHT -h -50; }
     }
 
-    // Render zombie with health bar
-    void render(SDL_Renderer* renderer, bool isMovingRight, bool isMovingLeft) override {
-        if (!renderer) {
-            std::cerr << "Renderer is null in Zombie::render\n"; // Error if renderer is null
-            return;
-        }
-        if (!runTextures[0]) {
-            std::cerr << "Zombie texture is null in Zombie::render\n"; // Error if texture is null
-            return;
-        }
+    // Render zombie with health bar using its group's texture
+    void render(SDL_Renderer* renderer, SDL_Texture* tex) const {
         SDL_Rect dst = {static_cast<int>(pos.x), static_cast<int>(pos.y), w, h}; // Destination rectangle
         SDL_RendererFlip flip = (vel.x >= 0) ? SDL_FLIP_HORIZONTAL : SDL_FLIP_NONE; // Flip based on movement
-        if (SDL_RenderCopyEx(renderer, runTextures[0], nullptr, &dst, 0.0, nullptr, flip) != 0) {
+        if (SDL_RenderCopyEx(renderer, tex, nullptr, &dst, 0.0, nullptr, flip) != 0) {
             std::cerr << "SDL_RenderCopyEx failed: " << SDL_GetError() << "\n"; // Error on render failure
         }
         SDL_SetRenderDrawColor(renderer, 255, 0, 0, 255); // Set color for health bar
@@ -336,80 +394,183 @@ public:
     }
 };
 
+// Where a zombie handle currently points
+struct ZombieLocation {
+    int group; // Archetype group, or -1 for a free handle
+    uint32_t index; // Index in the group
+};
+
+// All live zombies, stored by value in one contiguous array per archetype. Each group is kept in Morton order
+// of the zombies' cells, so zombies close on screen are close in memory; handles survive the reordering
+struct ZombieHorde {
+    static const int SORT_INTERVAL = 15; // Ticks between spatial sorts
+    std::vector<std::vector<Zombie>> groups; // Zombies of each archetype, indexed by archetype ID
+    std::vector<ZombieLocation> locations; // Indirection table: location of each handle
+    std::vector<uint32_t> freeHandles; // Released handles for reuse
+    SpatialSorter sorter; // Incremental sort state
+    std::vector<uint32_t> keys, lastKeys; // Scratch key arrays for one group
+    std::vector<Zombie> sorted; // Scratch group being rebuilt in sorted order
+    int ticksSinceSort = 0; // Ticks since the last spatial sort
+    size_t lastSortMoved = 0; // Zombies the last spatial sort moved, over all groups
+
+    // Total number of live zombies
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& group : groups) total += group.size();
+        return total;
+    }
+
+    // Appends a zombie to its archetype group and gives it a handle
+    Zombie& add(Zombie&& zombie) {
+        std::vector<Zombie>& group = groups[zombie.archetype];
+        uint32_t handle;
+        if (!freeHandles.empty()) {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+        } else {
+            handle = static_cast<uint32_t>(locations.size());
+            locations.push_back({-1, 0});
+        }
+        locations[handle] = {zombie.archetype, static_cast<uint32_t>(group.size())};
+        zombie.handle = handle;
+        group.push_back(std::move(zombie));
+        return group.back();
+    }
+
+    // Reserves room for count zombies per group, so spawning up to that many does not touch the heap
+    void reserve(size_t count) {
+        for (auto& group : groups) group.reserve(count);
+        sorted.reserve(count);
+        keys.reserve(count);
+        lastKeys.reserve(count);
+        locations.reserve(count * groups.size());
+        freeHandles.reserve(count * groups.size());
+    }
+
+    // Swap-removes a zombie, keeping the group contiguous and the moved zombie's handle valid
+    void remove(int id, size_t index) {
+        std::vector<Zombie>& group = groups[id];
+        locations[group[index].handle].group = -1;
+        freeHandles.push_back(group[index].handle);
+        if (index + 1 < group.size()) {
+            group[index] = std::move(group.back());
+            group[index].sortKey = UNSORTED_KEY; // Its old key belongs at the back; kept, it would push the rest out of order
+            locations[group[index].handle].index = static_cast<uint32_t>(index);
+        }
+        group.pop_back();
+    }
+
+    // Reports zombie storage, the handle table and the sort scratch arrays
+    void reportMemory(MemoryReport& report) const {
+        size_t capacity = 0;
+        for (const auto& group : groups) capacity += group.capacity();
+        report.add(MEM_ENTITIES, "zombie groups (" + std::to_string(sizeof(Zombie)) + " B per zombie)", capacity * sizeof(Zombie), size());
+        report.add(MEM_POOLS, "zombie handles", vectorBytes(locations) + vectorBytes(freeHandles), locations.size());
+        report.add(MEM_BUFFERS, "spatial sort scratch", vectorBytes(keys) + vectorBytes(lastKeys) + vectorBytes(sorted) + sorter.memoryBytes());
+    }
+
+    // Zombie behind a handle, or nullptr once it has been removed
+    Zombie* find(uint32_t handle) {
+        if (handle >= locations.size() || locations[handle].group < 0) return nullptr;
+        const ZombieLocation& at = locations[handle];
+        return &groups[at.group][at.index];
+    }
+
+    // Reorders every group by the Morton code of each zombie's center cell, every SORT_INTERVAL ticks.
+    // Zombies that kept their cell and their place stay put; only the rest are radix sorted and merged in.
+    // Returns whether a sort ran
+    bool sortSpatially() {
+        if (++ticksSinceSort < SORT_INTERVAL) return false;
+        ticksSinceSort = 0;
+        lastSortMoved = 0;
+        for (auto& group : groups) {
+            keys.resize(group.size());
+            lastKeys.resize(group.size());
+            for (size_t i = 0; i < group.size(); i++) {
+                const Zombie& zombie = group[i];
+                uint32_t cx = static_cast<uint32_t>(std::max(0.0f, zombie.pos.x + zombie.w / 2.0f)) / TILE_SIZE;
+                uint32_t cy = static_cast<uint32_t>(std::max(0.0f, zombie.pos.y + zombie.h / 2.0f)) / TILE_SIZE;
+                keys[i] = mortonCode(cx, cy);
+                lastKeys[i] = zombie.sortKey;
+            }
+            const std::vector<uint32_t>& order = sorter.sort(keys, lastKeys);
+            lastSortMoved += sorter.changedCount();
+            if (order.empty()) continue; // Already in order
+            sorted.clear();
+            for (uint32_t from : order) {
+                sorted.push_back(std::move(group[from]));
+                Zombie& zombie = sorted.back();
+                zombie.sortKey = keys[from];
+                locations[zombie.handle].index = static_cast<uint32_t>(sorted.size() - 1);
+            }
+            group.swap(sorted);
+        }
+        return true;
+    }
+};
+
+// Add a zombie of the given archetype, with stats read from the registry tables
+void addZombie(ZombieHorde& horde, const ArchetypeRegistry& registry, ZombieBrains& brains, float x, float y, int id) {
+    Zombie& zombie = horde.add(Zombie(x, y, registry.width[id], registry.height[id], registry.textures[id], id, registry.health[id]));
+    zombie.brain = brains.allocate(registry.aiProfile[id], x, registry.speed[id]); // Give the zombie an AI blackboard
+}
+
+// Reports the simulation state shared by the game and the memory benchmark
+void reportSimulationMemory(MemoryReport& report, const ZombieHorde& horde, const ZombieBrains& brains, const Terrain& terrain, const JumpTable& jumps) {
+    horde.reportMemory(report);
+    report.add(MEM_AI, "zombie blackboards", brains.memoryBytes(), brains.slotCount());
+    report.add(MEM_AI, "jump table", jumps.memoryBytes());
+    report.add(MEM_TERRAIN, "terrain tables", terrain.memoryBytes());
+}
+
 // Food class, inherits from PhysicsEntity
-class Food : public Zombie {
+class Food : public PhysicsEntity {
 public:
     double spawnTime; // Time when food was spawned
     static const int HEALTH_RESTORE = 20; // Health restored when collected
     static constexpr double LIFETIME = 10.0; // Time before food despawns
+    static const int SLEEP_TICKS = 30; // Ticks at rest before the food stops simulating
+    int restTicks; // Consecutive ticks spent at rest
+    bool sleeping; // Whether physics is skipped until something wakes the food
 
     // Constructor initializing food with position, size, and texture
     Food(float x, float y, int w_, int h_, SDL_Texture* tex)
-        : Zombie(x, y, w_, h_, tex, Zombie::ATTACK), spawnTime(SDL_GetTicks() / 1000.0) {
+        : PhysicsEntity(x, y, w_, h_, tex), spawnTime(SDL_GetTicks() / 1000.0), restTicks(0), sleeping(false) {
         health = 0; // Food has no health
         friction = false; // No friction for food
     }
 
     // Update food position and physics
-    void update(Terrain* terrain, bool hasInput) {
+    void update(Terrain* terrain) {
+        if (sleeping) return; // Resting food needs no simulation
         if (gravity) vel.y += GRAVITY; // Apply gravity
         if (onGround && friction && !vel.x) vel.x *= FRICTION; // Apply friction
         pos.add(vel); // Update position
 
-        onGround = false; // Reset ground state
-        if (grounded(terrain) && vel.y >= 0) { // Check if on ground
-            vel.y = 0;
-            onGround = true;
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.x + w > platformRect.x && pos.x < platformRect.x + platformRect.w &&
-                    pos.y + h >= platformRect.y && pos.y + h <= platformRect.y + 10) {
-                    pos.y = platformRect.y - h; // Snap to platform top
-                    break;
-                }
-            }
-        }
-
-        if (ceilingCol(terrain) && vel.y < 0) { // Check for ceiling collision
-            vel.y = 0;
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.x + w > platformRect.x && pos.x < platformRect.x + platformRect.w &&
-                    pos.y <= platformRect.y + platformRect.h && pos.y >= platformRect.y) {
-                    pos.y = platformRect.y + platformRect.h; // Snap to platform bottom
-                    break;
-                }
-            }
-        }
-
-        if (leftCol(terrain) && vel.x < 0 && !ceilingCol(terrain)) { // Check for left wall collision
-            vel.x = 0;
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.y + h > platformRect.y && pos.y < platformRect.y + platformRect.h &&
-                    pos.x <= platformRect.x + platformRect.w && pos.x >= platformRect.x) {
-                    pos.x = platformRect.x + platformRect.w; // Snap to right side
-                    break;
-                }
-            }
-        }
-        if (rightCol(terrain) && vel.x > 0 && !ceilingCol(terrain)) { // Check for right wall collision
-            vel.x = 0;
-            for (const auto& platform : terrain->platforms) {
-                SDL_Rect platformRect = {platform.x * TILE_SIZE, platform.y * TILE_SIZE, platform.width * TILE_SIZE, platform.height * TILE_SIZE};
-                if (pos.y + h > platformRect.y && pos.y < platformRect.y + platformRect.h &&
-                    pos.x + w >= platformRect.x && pos.x + w <= platformRect.x + platformRect.w) {
-                    pos.x = platformRect.x - w; // Snap to left side
-                    break;
-                }
-            }
-        }
+        collideTerrain(terrain); // Resolve platform collisions
 
         // Keep food within screen bounds
         if (pos.x < 0) { pos.x = 0; vel.x = 0; }
         if (pos.x > SCREEN_WIDTH - w) { pos.x = SCREEN_WIDTH - w; vel.x = 0; }
         if (pos.y < 0) { pos.y = 0; vel.y = 0; }
         if (pos.y > SCREEN_HEIGHT) { pos.y = SCREEN_HEIGHT - h; vel.y = 0; }
+
+        // Fall asleep after resting on static ground for a while
+        bool atRest = onGround && support < 0 && vel.x == 0.0f;
+        restTicks = atRest ? restTicks + 1 : 0;
+        if (restTicks >= SLEEP_TICKS) sleeping = true;
+    }
+
+    // Resume simulation (the ground under the food may have changed)
+    void wake() {
+        sleeping = false;
+        restTicks = 0;
+    }
+
+    // Render food
+    void render(SDL_Renderer* renderer) const {
+        SDL_Rect dst = {static_cast<int>(pos.x), static_cast<int>(pos.y), w, h}; // Destination rectangle
+        SDL_RenderCopyEx(renderer, runTextures[0], nullptr, &dst, 0.0, nullptr, SDL_FLIP_HORIZONTAL);
     }
 };
 
@@ -421,12 +582,16 @@ struct GameState {
     int score; // Current score
     double startTime; // Game start time
     bool isValid; // Whether the state is valid
-    std::vector<std::tuple<float, float, Zombie::Type>> zombies; // Store zombie position and type
+    std::vector<std::tuple<float, float, int>> zombies; // Store zombie position and archetype ID
     int wave; // Current wave
     int zombiesToSpawn; // Number of zombies left to spawn
     int waveZombiesRemaining; // Zombies remaining in current wave
     int weatherType; // Current weather state (DAY or NIGHT)
-    GameState() : isValid(false), wave(1), zombiesToSpawn(15), waveZombiesRemaining(0), weatherType(0) {} // Default constructor
+    int waveStep; // Await index the wave script is suspended on (1 = waiting for clear, as in older saves)
+    int pendingBosses; // Bosses queued but not yet spawned
+    double waveWaitRemaining; // Seconds left on a wave script's timed wait (-1 if none)
+    GameState() : isValid(false), wave(1), zombiesToSpawn(15), waveZombiesRemaining(0), weatherType(0),
+                  waveStep(1), pendingBosses(0), waveWaitRemaining(-1) {} // Default constructor
 };
 
 // Save game state to a binary file
@@ -453,6 +618,9 @@ void saveGameState(const GameState& state, const std::string& filename) {
         outFile.write(reinterpret_cast<const char*>(&state.zombiesToSpawn), sizeof(int)); // Save zombies to spawn
         outFile.write(reinterpret_cast<const char*>(&state.waveZombiesRemaining), sizeof(int)); // Save remaining zombies
         outFile.write(reinterpret_cast<const char*>(&state.weatherType), sizeof(int)); // Save weather state
+        outFile.write(reinterpret_cast<const char*>(&state.waveStep), sizeof(int)); // Save wave script step
+        outFile.write(reinterpret_cast<const char*>(&state.pendingBosses), sizeof(int)); // Save queued bosses
+        outFile.write(reinterpret_cast<const char*>(&state.waveWaitRemaining), sizeof(double)); // Save wave wait time left
         outFile.close();
     }
 }
@@ -477,12 +645,15 @@ GameState loadGameState(const std::string& filename) {
             inFile.read(reinterpret_cast<char*>(&x), sizeof(float)); // Load zombie x position
             inFile.read(reinterpret_cast<char*>(&y), sizeof(float)); // Load zombie y position
             inFile.read(reinterpret_cast<char*>(&type), sizeof(int)); // Load zombie type
-            state.zombies[i] = std::make_tuple(x, y, static_cast<Zombie::Type>(type));
+            state.zombies[i] = std::make_tuple(x, y, type);
         }
         inFile.read(reinterpret_cast<char*>(&state.wave), sizeof(int)); // Load wave number
         inFile.read(reinterpret_cast<char*>(&state.zombiesToSpawn), sizeof(int)); // Load zombies to spawn
         inFile.read(reinterpret_cast<char*>(&state.waveZombiesRemaining), sizeof(int)); // Load remaining zombies
         inFile.read(reinterpret_cast<char*>(&state.weatherType), sizeof(int)); // Load weather state
+        inFile.read(reinterpret_cast<char*>(&state.waveStep), sizeof(int)); // Load wave script step (absent in older saves)
+        inFile.read(reinterpret_cast<char*>(&state.pendingBosses), sizeof(int)); // Load queued bosses
+        inFile.read(reinterpret_cast<char*>(&state.waveWaitRemaining), sizeof(double)); // Load wave wait time left
         inFile.close();
         state.isValid = true; // Mark state as valid
     }
@@ -521,9 +692,9 @@ void loadAnimationTextures(int numFrames, SDL_Texture* textures[], const std::st
 }
 
 // Render text to a texture
-SDL_Texture* renderText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, SDL_Color color) {
-    if (text.empty() || text.find_first_not_of(' ') == std::string::npos) return nullptr; // Return null for empty text
-    SDL_Surface* surf = TTF_RenderText_Solid(font, text.c_str(), color); // Render text to surface
+SDL_Texture* renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color) {
+    if (text[std::strspn(text, " ")] == '\0') return nullptr; // Return null for empty text
+    SDL_Surface* surf = TTF_RenderText_Solid(font, text, color); // Render text to surface
     if (!surf) {
         std::cerr << "Text render error: " << TTF_GetError() << std::endl; // Log error if rendering fails
         return nullptr;
@@ -536,53 +707,581 @@ SDL_Texture* renderText(SDL_Renderer* renderer, TTF_Font* font, const std::strin
     return tex;
 }
 
-// Spawn a zombie at a random platform
-void spawnZombie(std::vector<Zombie*>& zombies, const Terrain& terrain, SDL_Texture* attackTex, SDL_Texture* tankTex) {
-    if (terrain.platforms.empty()) {
-        std::cerr << "No platforms available for zombie spawning\n"; // Log error if no platforms
+// Render text to a texture
+SDL_Texture* renderText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, SDL_Color color) {
+    return renderText(renderer, font, text.c_str(), color);
+}
+
+// Spawn a zombie on a random spawn surface (archetype picked by spawn weight unless forcedType is given).
+// The spot is checked with Terrain::boxFits, since an archetype taller than the spawn box
+// has no guaranteed headroom
+void spawnZombie(ZombieHorde& horde, const SpawnScheduler& spawner, const Terrain& terrain, const ArchetypeRegistry& registry, ZombieBrains& brains, int forcedType = -1) {
+    const int SPAWN_ATTEMPTS = 4; // Surfaces tried before giving up on this spawn
+    if (spawner.empty()) {
+        std::cerr << "No spawn surfaces available for zombie spawning\n"; // Log error if no surfaces
         return;
     }
     static std::random_device rd; // Random device for seeding
     static std::mt19937 gen(rd()); // Mersenne Twister generator
-    std::uniform_int_distribution<> platformDist(0, terrain.platforms.size() - 1); // Random platform index
-    std::uniform_int_distribution<> typeDist(0, 1); // Random zombie type (ATTACK or TANK)
-    std::uniform_real_distribution<> xDist(0.0f, 1.0f); // Random x position on platform
-
-    const auto& platform = terrain.platforms[platformDist(gen)]; // Select random platform
-    float x = platform.x * TILE_SIZE + xDist(gen) * (platform.width * TILE_SIZE - 32); // Random x position
-    float y = platform.y * TILE_SIZE - 32; // Position above platform
-    Zombie::Type type = typeDist(gen) == 0 ? Zombie::ATTACK : Zombie::TANK; // Random type
-    SDL_Texture* tex = (type == Zombie::ATTACK) ? attackTex : tankTex; // Select texture based on type
-    if (!tex) {
-        std::cerr << "Zombie texture is null, cannot spawn zombie at (" << x << ", " << y << ")\n"; // Log error if texture missing
+
+    float x, y;
+    int type = forcedType >= 0 ? forcedType : registry.pickRandom(gen); // Archetype by spawn weight
+    bool clear = false;
+    for (int attempt = 0; attempt < SPAWN_ATTEMPTS && !clear; attempt++) {
+        spawner.pick(gen, x, y); // Surface picked by span length
+        y += spawner.getBoxHeight() - registry.height[type]; // Surfaces are computed for the spawn box height
+        clear = terrain.boxFits(x, y, registry.width[type], registry.height[type]);
+    }
+    if (!clear) {
+        std::cerr << "No room to spawn " << registry.names[type] << " zombie\n"; // Log error if every spot was blocked
         return;
     }
-    std::cout << "Spawning zombie at (" << x << ", " << y << ") type: " << (type == Zombie::ATTACK ? "ATTACK" : "TANK") << "\n"; // Log spawn
-    Zombie* newZombie = new Zombie(x, y, 32, 32, tex, type); // Create new zombie
-    if (!newZombie) {
-        std::cerr << "Failed to create zombie object\n"; // Log error if creation fails
+    if (!registry.textures[type]) {
+        std::cerr << "Zombie texture is null, cannot spawn zombie at (" << x << ", " << y << ")\n"; // Log error if texture missing
         return;
     }
-    zombies.push_back(newZombie); // Add to zombie list
+    addZombie(horde, registry, brains, x, y, type); // Add to the zombie's archetype group
 }
 
-// Spawn food with 50% chance at zombie's position
-void spawnFood(std::vector<Food*>& foods, float x, float y, SDL_Texture* foodTex) {
+// Spawn food at zombie's position (the drop chance comes from the archetype's drop table)
+void spawnFood(std::vector<Food>& foods, float x, float y, SDL_Texture* foodTex) {
     if (!foodTex) {
         std::cerr << "Food texture not loaded\n"; // Log error if texture missing
         return;
     }
-    static std::random_device rd; // Random device for seeding
-    static std::mt19937 gen(rd()); // Mersenne Twister generator
-    std::uniform_real_distribution<> chance(0.0f, 1.0f); // Random chance for spawning
-    if (chance(gen) < 0.5f) { // 50% chance to spawn
-        foods.push_back(new Food(x, y, 16, 16, foodTex)); // Create new food
-        std::cout << "Spawned food at (" << x << ", " << y << ")\n"; // Log spawn
+    foods.emplace_back(x, y, 16, 16, foodTex); // Create new food
+    std::cout << "Spawned food at (" << x << ", " << y << ")\n"; // Log spawn
+}
+
+// Per-tick state shared by every zombie group update
+struct ZombieTick {
+    Terrain* terrain; // Level collision
+    ZombieHorde* horde; // Zombie storage (removals go through it to keep handles valid)
+    ZombieBrains* brains; // AI blackboards
+    PhysicsEntity* player; // Player being chased
+    SDL_Rect playerRect; // Player's bounding rectangle
+    bool attacking; // Whether the player attacked this tick
+    SDL_Rect attackRect; // Player's melee hitbox
+    int meleeDamage; // Damage dealt by one melee hit
+    double currentTime; // Current time in seconds
+    const ArchetypeRegistry* registry; // Archetype tables
+    std::mt19937* rng; // Random generator for drop rolls
+    std::vector<Food>* foods; // Food drops
+    SDL_Texture* foodTex; // Food texture
+    int kills; // Zombies killed this tick
+};
+
+// Write AI senses for one archetype group
+void senseZombieGroup(const std::vector<Zombie>& group, Terrain* terrain, ZombieBrains& brains, float maxHealth) {
+    for (const auto& zombie : group) zombie.sense(terrain, brains, maxHealth);
+}
+
+// Re-form the squads of one archetype group; the group is in spatial order, so squads are runs of neighbours
+void formZombieSquads(const std::vector<Zombie>& group, ZombieBrains& brains, FrameArena& arena) {
+    FrameVector<int> slots(&arena); // Brain slots in group order
+    slots.reserve(group.size());
+    for (const auto& zombie : group) {
+        if (zombie.brain >= 0) slots.push_back(zombie.brain);
     }
+    brains.formSquads(slots);
+}
+
+// Update one archetype group: physics, contact damage, melee hits and deaths.
+// Archetype stats are read from the tables once per group, so the per-zombie loop has no type branches
+void updateZombieGroup(std::vector<Zombie>& group, int id, ZombieTick& tick) {
+    const float HEAVY_LANDING_SPEED = 12.0f; // Fall speed at which heavy zombies break the tiles they land on
+    const float CRATER_RADIUS = 36.0f; // Reach of a heavy landing, in pixels from the feet
+    const int damage = tick.registry->damage[id]; // Damage dealt to player
+    const bool hasDrops = tick.registry->dropBegin[id] != tick.registry->dropEnd[id];
+    const bool heavy = tick.registry->heavy[id];
+    for (size_t i = 0; i < group.size();) {
+        Zombie& zombie = group[i];
+        float fallSpeed = zombie.vel.y + GRAVITY; // Speed the zombie hits the ground with if it lands this tick
+        zombie.update(tick.terrain, *tick.brains); // Update zombie
+        if (heavy && zombie.onGround && fallSpeed >= HEAVY_LANDING_SPEED && zombie.support < 0) {
+            tick.terrain->destroyCircle(zombie.pos.x + zombie.w / 2.0f, zombie.pos.y + zombie.h + TILE_SIZE / 2.0f, CRATER_RADIUS);
+        }
+        SDL_Rect zombieRect = zombie.getRect(); // Zombie's bounding rectangle
+        if (SDL_HasIntersection(&tick.playerRect, &zombieRect) && tick.currentTime - zombie.lastDamageTime >= 1.0) {
+            tick.player->health -= damage; // Damage player
+            zombie.lastDamageTime = tick.currentTime;
+            if (tick.player->health < 0) tick.player->health = 0;
+        }
+        if (tick.attacking && SDL_HasIntersection(&tick.attackRect, &zombieRect)) { // Handle player attack
+            zombie.health -= tick.meleeDamage; // Damage zombie
+            if (zombie.health <= 0) {
+                if (hasDrops && tick.registry->rollDrop(id, *tick.rng) == DROP_FOOD) {
+                    spawnFood(*tick.foods, zombie.pos.x, zombie.pos.y, tick.foodTex); // Spawn food on death
+                }
+                tick.brains->release(zombie.brain); // Free AI blackboard slot
+                tick.kills++;
+                tick.horde->remove(id, i); // Swap-remove keeps the group contiguous
+                continue;
+            }
+        }
+        i++;
+    }
+}
+
+// Render one archetype group with its shared texture
+void renderZombieGroup(const std::vector<Zombie>& group, SDL_Renderer* renderer, SDL_Texture* tex) {
+    if (group.empty()) return;
+    if (!renderer || !tex) {
+        std::cerr << "Renderer or zombie texture is null in renderZombieGroup\n"; // Error if renderer or texture is null
+        return;
+    }
+    for (const auto& zombie : group) zombie.render(renderer, tex);
+}
+
+// Shared state record of an entity
+static SharedEntity sharedEntity(const PhysicsEntity& entity, int kind, uint32_t id) {
+    return {entity.pos.x, entity.pos.y, entity.vel.x, entity.vel.y, entity.health, kind, id, 0};
+}
+
+// Writes the frame into the shared state segment (--shared-state); records go straight into the mapping
+void publishSharedState(SharedFrame& frame, const PhysicsEntity& player, const ZombieHorde& horde, const std::vector<Food>& foods) {
+    frame.player = sharedEntity(player, 0, 0);
+    SharedEntity* zombies = sharedStateZombies();
+    uint32_t capacity = sharedStateZombieCapacity(), count = 0, dropped = 0;
+    for (const auto& group : horde.groups) {
+        for (const auto& zombie : group) {
+            if (count < capacity) zombies[count++] = sharedEntity(zombie, zombie.archetype, zombie.handle);
+            else dropped++;
+        }
+    }
+    frame.zombieCount = count;
+    frame.zombiesDropped = dropped;
+    SharedEntity* food = sharedStateFood();
+    uint32_t foodCount = std::min(static_cast<uint32_t>(foods.size()), sharedStateFoodCapacity());
+    for (uint32_t i = 0; i < foodCount; i++) {
+        food[i] = sharedEntity(foods[i], 0, i);
+        food[i].health = 0;
+    }
+    frame.foodCount = foodCount;
+}
+
+// Runs a benchmark body in a child process, so every run starts from the same memory state. body(result) fills
+// result in the child, which sends it back through a pipe; peakKb gets the child's peak RSS. Returns false if the
+// child could not be started, failed or sent nothing (the caller says which run)
+template <typename Result, typename Body>
+static bool runInChild(Body&& body, Result& result, long& peakKb) {
+    static_assert(std::is_trivially_copyable_v<Result>, "Results cross the pipe as raw bytes");
+    int channel[2];
+    if (pipe(channel) != 0) {
+        std::cerr << "Benchmark: pipe failed\n";
+        return false;
+    }
+    std::cout.flush(); // Otherwise the child inherits buffered output and prints it again
+    pid_t child = fork();
+    if (child < 0) {
+        std::cerr << "Benchmark: fork failed\n";
+        close(channel[0]);
+        close(channel[1]);
+        return false;
+    }
+    if (child == 0) {
+        close(channel[0]);
+        bool ok = body(result);
+        ok = ok && write(channel[1], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+        _exit(ok ? 0 : 1);
+    }
+    close(channel[1]);
+    bool received = read(channel[0], &result, sizeof(result)) == static_cast<ssize_t>(sizeof(result));
+    close(channel[0]);
+    int status = 0;
+    struct rusage usage;
+    if (wait4(child, &status, 0, &usage) != child || !WIFEXITED(status) || WEXITSTATUS(status) != 0 || !received) return false;
+    peakKb = usage.ru_maxrss; // Kilobytes on Linux
+    return true;
+}
+
+// Generates the map the benchmarks run on when params is given (--bench-map), and writes which map that is, with the
+// generated map's checksum, so results can be matched to their map. Without params the built-in level is used and
+// map stays empty. Returns false if the map cannot be generated
+static bool prepareBenchMap(const MapParams* params, GeneratedMap& map, std::ostream& out, const char* prefix) {
+    if (!params) {
+        out << prefix << "map: built-in level, " << DEFAULT_COLS << "x" << DEFAULT_ROWS << " tiles\n";
+        return true;
+    }
+    if (!generateMap(*params, map)) return false;
+    out << prefix << "map: seed " << params->seed << ", " << params->cols << "x" << params->rows << " tiles, density "
+        << params->density << ", " << map.platforms.size() << " platforms, checksum " << std::hex << mapChecksum(map)
+        << std::dec << "\n";
+    return true;
+}
+
+// Terrain a benchmark runs on: the generated map if prepareBenchMap made one, the built-in level otherwise
+static Terrain benchTerrain(const GeneratedMap& map) {
+    if (!map.platforms.empty()) return makeTerrain(map);
+    return Terrain(DEFAULT_PLATFORMS, DEFAULT_PLATFORM_RECTS, DEFAULT_SOLID_BITS.data(), DEFAULT_COLS, DEFAULT_ROWS, TILE_SIZE);
+}
+
+// One memory benchmark run: count zombies spread over the benchmark map, with a spatial sort, senses, squads
+// and tree evaluation run over them so scratch buffers reach their working size. Headless: no textures
+static bool populateForBenchmark(int count, const GeneratedMap& map, MemoryReport& report) {
+    ZombieBrains brains;
+    ArchetypeRegistry registry;
+    if (!registry.load("zombies.cfg", brains)) return false;
+    Terrain terrain = benchTerrain(map);
+    std::vector<float> jumpSpeeds(registry.speed.begin(), registry.speed.end());
+    JumpTable jumps;
+    jumps.build(terrain, jumpSpeeds, brains.jumpForces(), GRAVITY);
+    brains.setJumpTable(&jumps);
+    ZombieHorde horde;
+    horde.groups.resize(registry.count());
+    FrameArena frameArena(64 * 1024);
+    std::mt19937 gen(1); // Fixed seed: every run places the same zombies
+    std::uniform_real_distribution<float> spreadX(10.0f, SCREEN_WIDTH - 100.0f), spreadY(0.0f, SCREEN_HEIGHT - 100.0f);
+    for (int i = 0; i < count; i++) {
+        addZombie(horde, registry, brains, spreadX(gen), spreadY(gen), registry.pickRandom(gen));
+    }
+    for (int tick = 0; tick < ZombieHorde::SORT_INTERVAL; tick++) {
+        bool resorted = horde.sortSpatially();
+        for (int id = 0; id < registry.count(); id++) {
+            if (resorted) formZombieSquads(horde.groups[id], brains, frameArena);
+            senseZombieGroup(horde.groups[id], &terrain, brains, static_cast<float>(registry.health[id]));
+        }
+        brains.evaluate(SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f, tick / 60.0);
+        frameArena.reset();
+    }
+    reportSimulationMemory(report, horde, brains, terrain, jumps);
+    report.add(MEM_BUFFERS, "frame arena", frameArena.getCapacity());
+    return true;
+}
+
+// Memory scaling benchmark (tgame4 --mem-bench): peak RSS with 1k, 10k and 100k zombies against an empty run, on the
+// built-in level or the generated map described by mapParams. Each count runs in a child process, so every peak is
+// measured from the same starting point. Returns 0 on success, 1 if the map or a run failed
+int RunMemoryBenchmark(const MapParams* mapParams) {
+    const int COUNTS[] = {0, 1000, 10000, 100000}; // Zombie counts; the empty run is the baseline
+    long baselineKb = 0; // Peak RSS of the empty run
+    size_t baselineReported[MEM_TAG_COUNT] = {}; // Reported bytes of the empty run
+    GeneratedMap map; // Generated before the children fork, so the empty run carries it too
+    if (!prepareBenchMap(mapParams, map, std::cout, "# ")) return 1;
+    std::cout << "zombies,peak_rss_kb,rss_bytes_per_zombie,reported_bytes_per_zombie,entity_bytes_per_zombie,ai_bytes_per_zombie\n";
+    for (int count : COUNTS) {
+        size_t reported[MEM_TAG_COUNT] = {}; // Reported bytes per tag
+        long peakKb = 0;
+        auto run = [count, &map](size_t (&bytes)[MEM_TAG_COUNT]) {
+            MemoryReport report;
+            if (!populateForBenchmark(count, map, report)) return false;
+            for (int tag = 0; tag < MEM_TAG_COUNT; tag++) bytes[tag] = report.total(static_cast<MemoryTag>(tag));
+            return true;
+        };
+        if (!runInChild(run, reported, peakKb)) {
+            std::cerr << "Memory benchmark: run with " << count << " zombies failed (check zombies.cfg)\n";
+            return 1;
+        }
+        if (count == 0) {
+            baselineKb = peakKb;
+            std::copy(std::begin(reported), std::end(reported), std::begin(baselineReported));
+        }
+        size_t reportedTotal = 0, baselineTotal = 0;
+        for (int tag = 0; tag < MEM_TAG_COUNT; tag++) {
+            reportedTotal += reported[tag];
+            baselineTotal += baselineReported[tag];
+        }
+        auto perZombie = [count](double bytes) { return count > 0 ? bytes / count : 0.0; };
+        std::cout << count << "," << peakKb << "," << perZombie((peakKb - baselineKb) * 1024.0) << ","
+                  << perZombie(static_cast<double>(reportedTotal) - baselineTotal) << ","
+                  << perZombie(static_cast<double>(reported[MEM_ENTITIES]) - baselineReported[MEM_ENTITIES]) << ","
+                  << perZombie(static_cast<double>(reported[MEM_AI]) - baselineReported[MEM_AI]) << "\n";
+    }
+    return 0;
+}
+
+// Seconds a call takes
+template <typename Call>
+static double timeSeconds(Call&& call) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    call();
+    return (SDL_GetPerformanceCounter() - start) / static_cast<double>(SDL_GetPerformanceFrequency());
+}
+
+// Fraction of a file's pages in the page cache, or -1 if it cannot be checked
+static double cachedFraction(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1.0;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return -1.0;
+    }
+    size_t bytes = static_cast<size_t>(info.st_size);
+    void* mapping = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) return -1.0;
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    std::vector<unsigned char> resident((bytes + page - 1) / page);
+    double fraction = -1.0;
+    if (mincore(mapping, bytes, resident.data()) == 0) {
+        fraction = std::count_if(resident.begin(), resident.end(), [](unsigned char r) { return r & 1; }) / static_cast<double>(resident.size());
+    }
+    munmap(mapping, bytes);
+    return fraction;
+}
+
+// Flushes a file to disk and asks the kernel to drop it from the page cache, which needs no root (dropping every
+// cache through /proc/sys/vm/drop_caches would). Returns the time the flush took, or -1 if the file cannot be opened
+static double flushAndEvict(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1.0;
+    double seconds = timeSeconds([fd]() { fsync(fd); });
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED); // Clean pages only, hence the fsync first
+    close(fd);
+    return seconds;
+}
+
+// Median of a few timings
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n == 0 ? 0.0 : n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2.0;
+}
+
+// Save benchmark results of one world size, sent from the child process
+struct SaveBenchResult {
+    double fileBytes; // Size of the save file
+    double saveSeconds; // saveGameState, up to the file being closed (page cache, not disk)
+    double flushSeconds; // fsync after the save: the cost of making it durable
+    double coldLoadSeconds; // loadGameState with the file evicted from the page cache
+    double coldCached; // Fraction of the file still cached before the cold load (0 when eviction worked)
+    double warmLoadSeconds; // loadGameState right after another load
+};
+
+// One save benchmark run: a world of count zombies saved and loaded SAVE_BENCH_REPEATS times. Medians go to result
+static bool runSaveBenchmark(int count, const char* path, SaveBenchResult& result) {
+    const int SAVE_BENCH_REPEATS = 5; // Timed save/load rounds per world size
+    GameState state;
+    state.isValid = true;
+    state.zombies.reserve(count);
+    std::mt19937 gen(1); // Fixed seed: every run saves the same world
+    std::uniform_real_distribution<float> spreadX(10.0f, SCREEN_WIDTH - 100.0f), spreadY(0.0f, SCREEN_HEIGHT - 100.0f);
+    for (int i = 0; i < count; i++) state.zombies.emplace_back(spreadX(gen), spreadY(gen), i % 2);
+    std::vector<double> saves, flushes, cold, cached, warm;
+    bool ok = true;
+    for (int r = 0; r < SAVE_BENCH_REPEATS && ok; r++) {
+        saves.push_back(timeSeconds([&]() { saveGameState(state, path); }));
+        flushes.push_back(flushAndEvict(path));
+        cached.push_back(cachedFraction(path));
+        size_t loaded = 0;
+        cold.push_back(timeSeconds([&]() { loaded = loadGameState(path).zombies.size(); }));
+        warm.push_back(timeSeconds([&]() { loaded = loadGameState(path).zombies.size(); }));
+        ok = loaded == static_cast<size_t>(count) && flushes.back() >= 0.0;
+    }
+    std::error_code error;
+    result.fileBytes = static_cast<double>(std::filesystem::file_size(path, error));
+    std::remove(path);
+    result.saveSeconds = median(saves);
+    result.flushSeconds = median(flushes);
+    result.coldLoadSeconds = median(cold);
+    result.coldCached = median(cached);
+    result.warmLoadSeconds = median(warm);
+    return ok && !error;
+}
+
+// Save/load benchmark (tgame4 --save-bench): latency, throughput, file size and peak RSS of saveGameState and
+// loadGameState for worlds of 10 to 1M zombies, loaded cold (evicted from the page cache) and warm. Each size runs in
+// a child process, so every peak is measured from the same starting point. Returns 0 on success, 1 if a run failed
+int RunSaveBenchmark() {
+    const int COUNTS[] = {0, 10, 100, 1000, 10000, 100000, 1000000}; // Zombie counts; the empty run is the baseline
+    const char* SAVE_FILE = "bench_savegame.tmp"; // Next to savegame.dat, so it is on the same file system
+    long baselineKb = 0; // Peak RSS of the empty run
+    std::cout << "zombies,file_bytes,save_ms,save_mb_per_s,fsync_ms,cold_load_ms,cold_cached_pct,warm_load_ms,"
+                 "warm_load_mb_per_s,peak_rss_kb,rss_over_empty_kb\n";
+    for (int count : COUNTS) {
+        SaveBenchResult result = {};
+        long peakKb = 0;
+        if (!runInChild([count, SAVE_FILE](SaveBenchResult& r) { return runSaveBenchmark(count, SAVE_FILE, r); }, result, peakKb)) {
+            std::cerr << "Save benchmark: run with " << count << " zombies failed (is the directory writable?)\n";
+            return 1;
+        }
+        if (count == 0) baselineKb = peakKb;
+        auto megabytesPerSecond = [&result](double seconds) { return seconds > 0.0 ? result.fileBytes / seconds / 1e6 : 0.0; };
+        std::cout << count << "," << static_cast<long long>(result.fileBytes) << "," << result.saveSeconds * 1000.0 << ","
+                  << megabytesPerSecond(result.saveSeconds) << "," << result.flushSeconds * 1000.0 << ","
+                  << result.coldLoadSeconds * 1000.0 << "," << result.coldCached * 100.0 << ","
+                  << result.warmLoadSeconds * 1000.0 << "," << megabytesPerSecond(result.warmLoadSeconds) << ","
+                  << peakKb << "," << peakKb - baselineKb << "\n";
+    }
+    return 0;
+}
+
+// Micro-benchmarks (tgame4 --micro-bench): hot helpers timed in isolation against the built-in level, or the
+// generated map described by mapParams. Headless: a software renderer on an off-screen surface stands in for the
+// window. savePath writes the medians as a new baseline; baselinePath compares against one. Returns 1 if the map
+// cannot be generated, a cost check fails (one kill must not re-sort the whole horde), a benchmark is more than
+// threshold slower than its baseline, a baseline entry has no result, a result has no baseline entry (unless
+// allowNew) or the baseline cannot be read, 0 otherwise
+int RunMicroBenchmarks(const char* savePath, const char* baselinePath, double threshold, bool allowNew, const MapParams* mapParams) {
+    const int POINTS = 4096; // Query points and probe entities, a power of two so indices wrap with a mask
+    const int ZOMBIES = 1000; // Zombies updated round-robin
+    const int SAVED_ZOMBIES = 100; // Zombies in the benchmarked save file
+    const char* SAVE_FILE = "bench_save.tmp"; // Scratch save file, removed at the end
+    BenchSuite suite;
+    bool checksFailed = false; // Set when a cost check run next to the benchmarks fails
+    std::mt19937 gen(1); // Fixed seed: every run measures the same inputs
+
+    GeneratedMap map; // Must outlive the terrain viewing it
+    if (!prepareBenchMap(mapParams, map, std::cout, "")) return 1;
+    Terrain terrain = benchTerrain(map);
+    int mapWidth = map.platforms.empty() ? DEFAULT_COLS * TILE_SIZE : map.params.cols * map.params.tileSize;
+    int mapHeight = map.platforms.empty() ? DEFAULT_ROWS * TILE_SIZE : map.params.rows * map.params.tileSize;
+    std::uniform_int_distribution<int> pointX(0, mapWidth - 1), pointY(0, mapHeight - 1);
+    std::vector<int> px(POINTS), py(POINTS);
+    for (int i = 0; i < POINTS; i++) {
+        px[i] = pointX(gen);
+        py[i] = pointY(gen);
+    }
+    suite.run("terrain_getSolid", [&](uint64_t n) {
+        int solid = 0;
+        for (uint64_t i = 0; i < n; i++) solid += terrain.getSolid(px[i & (POINTS - 1)], py[i & (POINTS - 1)]);
+        benchKeep(solid);
+    });
+
+    // Collision probes on player-sized entities scattered over the level
+    std::vector<PhysicsEntity> probes;
+    probes.reserve(POINTS);
+    for (int i = 0; i < POINTS; i++) probes.emplace_back(static_cast<float>(px[i]), static_cast<float>(py[i]), 48, 48, static_cast<SDL_Texture*>(nullptr));
+    auto probeBench = [&](const char* name, float velX, bool (PhysicsEntity::*probe)(Terrain*)) {
+        for (auto& entity : probes) entity.vel.x = velX; // Wall probes only look in the direction of travel
+        suite.run(name, [&](uint64_t n) {
+            int hits = 0;
+            for (uint64_t i = 0; i < n; i++) hits += (probes[i & (POINTS - 1)].*probe)(&terrain);
+            benchKeep(hits);
+        });
+    };
+    probeBench("probe_grounded", 0.0f, &PhysicsEntity::grounded);
+    probeBench("probe_ceiling", 0.0f, &PhysicsEntity::ceilingCol);
+    probeBench("probe_left", -1.0f, &PhysicsEntity::leftCol);
+    probeBench("probe_right", 1.0f, &PhysicsEntity::rightCol);
+
+    // Headless renderer and font for text and textures
+    SDL_Surface* canvas = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_RGBA8888);
+    SDL_Renderer* ren = canvas ? SDL_CreateSoftwareRenderer(canvas) : nullptr;
+    bool ttfStarted = !TTF_WasInit() && TTF_Init() == 0;
+    TTF_Font* font = TTF_WasInit() ? TTF_OpenFont("arial.ttf", 24) : nullptr;
+    if (ren && font) {
+        SDL_Color white = {255, 255, 255, 255};
+        suite.run("renderText", [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) SDL_DestroyTexture(renderText(ren, font, "Score: 12345", white)); // A HUD label
+        });
+    } else {
+        suite.skip("renderText", ren ? "arial.ttf not found" : "no software renderer");
+    }
+
+    // Save and load of a game with a typical horde
+    GameState saved;
+    saved.isValid = true;
+    for (int i = 0; i < SAVED_ZOMBIES; i++) saved.zombies.emplace_back(static_cast<float>(px[i]), static_cast<float>(py[i]), i % 2);
+    suite.run("saveGameState_100", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) saveGameState(saved, SAVE_FILE);
+    });
+    suite.run("loadGameState_100", [&](uint64_t n) {
+        for (uint64_t i = 0; i < n; i++) benchKeep(loadGameState(SAVE_FILE).zombies.size());
+    });
+    std::remove(SAVE_FILE);
+
+    // Zombie updates and spawning need the archetypes, and spawning their textures
+    ZombieBrains brains;
+    ArchetypeRegistry registry;
+    if (registry.load("zombies.cfg", brains)) {
+        if (ren) registry.loadTextures(ren);
+        ZombieHorde horde;
+        horde.groups.resize(registry.count());
+        std::uniform_real_distribution<float> spreadX(10.0f, SCREEN_WIDTH - 100.0f), spreadY(0.0f, SCREEN_HEIGHT - 100.0f);
+        for (int i = 0; i < ZOMBIES; i++) addZombie(horde, registry, brains, spreadX(gen), spreadY(gen), registry.pickRandom(gen));
+
+        // A settled horde must stay cheap to sort after a kill: only the zombie moved into the gap is re-sorted
+        while (!horde.sortSpatially()) {}
+        for (int id = 0; id < registry.count(); id++) {
+            if (horde.groups[id].size() > 1) {
+                brains.release(horde.groups[id][0].brain);
+                horde.remove(id, 0);
+                break;
+            }
+        }
+        while (!horde.sortSpatially()) {}
+        if (horde.lastSortMoved > 1) {
+            std::cerr << "Spatial sort: one removal moved " << horde.lastSortMoved << " zombies (expected at most 1)\n";
+            checksFailed = true;
+        }
+
+        std::vector<Zombie*> zombies;
+        for (auto& group : horde.groups) {
+            for (auto& zombie : group) zombies.push_back(&zombie);
+        }
+        // Updates move the zombies (falling, landing, stopping at walls); every repeat starts from the populated horde
+        std::vector<std::vector<Zombie>> settled = horde.groups;
+        auto restoreHorde = [&]() {
+            for (size_t id = 0; id < settled.size(); id++) std::copy(settled[id].begin(), settled[id].end(), horde.groups[id].begin());
+        };
+        suite.run("zombie_update", restoreHorde, [&](uint64_t n) {
+            for (uint64_t i = 0; i < n; i++) zombies[i % zombies.size()]->update(&terrain, brains);
+        });
+
+        // Spawning grows the horde; each repeat ends by emptying it again, which is timed with it
+        auto clearHorde = [&]() {
+            for (auto& group : horde.groups) {
+                for (const auto& zombie : group) brains.release(zombie.brain);
+                group.clear();
+            }
+            horde.locations.clear();
+            horde.freeHandles.clear();
+        };
+        clearHorde();
+        SpawnScheduler spawner(0.008);
+        if (map.platforms.empty()) {
+            spawner.load(DEFAULT_SPAWN_SURFACES.data(), DEFAULT_SPAWN_SURFACES.size(), DEFAULT_SPAWN_BOX);
+        } else {
+            SDL_Rect bounds = {10, 0, mapWidth - 40, mapHeight}; // The whole map, with the margins of DEFAULT_SPAWN_BOUNDS
+            spawner.build(terrain.rects, registry.maxWidth(), registry.maxHeight(), bounds);
+        }
+        bool textured = registry.count() > 0 && registry.textures[0];
+        if (textured) {
+            suite.run("spawnZombie", [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; i++) spawnZombie(horde, spawner, terrain, registry, brains);
+                clearHorde();
+            });
+        } else {
+            suite.skip("spawnZombie", "no zombie textures");
+        }
+        if (textured) {
+            // spawnFood logs every drop; the log goes to a sink so the terminal is not part of the measurement
+            struct NullBuffer : std::streambuf {
+                int overflow(int c) override { return c; }
+            } sink;
+            std::streambuf* console = std::cout.rdbuf(&sink);
+            std::vector<Food> foods;
+            suite.run("spawnFood", [&](uint64_t n) {
+                for (uint64_t i = 0; i < n; i++) spawnFood(foods, static_cast<float>(px[i & (POINTS - 1)]), 100.0f, registry.textures[0]);
+                foods.clear();
+            });
+            std::cout.rdbuf(console);
+        } else {
+            suite.skip("spawnFood", "no textures");
+        }
+        registry.destroyTextures();
+    } else {
+        suite.skip("zombie_update", "zombies.cfg not loaded");
+        suite.skip("spawnZombie", "zombies.cfg not loaded");
+        suite.skip("spawnFood", "zombies.cfg not loaded");
+    }
+
+    if (font) TTF_CloseFont(font);
+    if (ttfStarted) TTF_Quit();
+    if (ren) SDL_DestroyRenderer(ren);
+    if (canvas) SDL_FreeSurface(canvas);
+
+    suite.print(std::cout);
+    if (checksFailed) return 1; // Timings of broken code make no baseline
+    if (savePath && !suite.save(savePath)) return 1;
+    if (baselinePath) return suite.compare(baselinePath, threshold, allowNew, std::cout) == 0 ? 0 : 1;
+    return 0;
 }
 
 // Main game loop function
-int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win, SDL_Renderer* ren) {
+int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win, SDL_Renderer* ren, const char* levelPath) {
     // Load font for text rendering
     TTF_Font* font = TTF_OpenFont("arial.ttf", 24);
     if (!font) { 
@@ -602,28 +1301,41 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
     SDL_Texture* bgTex = loadTexture("day.png", ren); // Background texture
     SDL_Texture* platformTex = loadTexture("tile_wall.png", ren); // Platform texture
     SDL_Texture* playerTex = loadTexture("player.png", ren); // Player texture
-    SDL_Texture* attackZombieTex = loadTexture("attack_zombie.png", ren); // Attack zombie texture
-    SDL_Texture* tankZombieTex = loadTexture("tank_zombie.png", ren); // Tank zombie texture
     SDL_Texture* foodTex = loadTexture("food.png", ren); // Food texture
+    SDL_Texture* tileset[] = {nullptr, platformTex}; // Texture of each tile ID (0 is empty)
+    const int TILESET_SIZE = sizeof(tileset) / sizeof(tileset[0]);
+
+    // Map a baked level file if one was given (run "make levels" to produce it), otherwise use the built-in level
+    Level level;
+    bool levelLoaded = !levelPath || level.load(levelPath, TILE_SIZE);
     
     SDL_Texture* runTextures[10]; // Player run animation textures
     SDL_Texture* standTextures[12]; // Player stand animation textures
     loadAnimationTextures(10, runTextures, "player_run", ren); // Load run animations
     loadAnimationTextures(12, standTextures, "player_stand", ren); // Load stand animations
 
+    // Load zombie archetypes and their sprites
+    ZombieBrains brains; // Behavior tree blackboards for all zombies
+    ArchetypeRegistry registry; // Zombie archetype tables
+    bool archetypesLoaded = registry.load("zombies.cfg", brains) && registry.loadTextures(ren);
+
     // Check for missing critical textures
-    if (!attackZombieTex || !tankZombieTex) {
-        std::cerr << "Critical texture missing: attackTex or tankTex null. Check assets folder.\n";
+    if (!archetypesLoaded) {
+        std::cerr << "Critical zombie data missing: check zombies.cfg and the zombie sprites in the assets folder.\n";
     }
     bool texturesLoaded = true;
     for (int i = 0; i < 10; i++) if (!runTextures[i]) texturesLoaded = false; // Check run textures
     for (int i = 0; i < 12; i++) if (!standTextures[i]) texturesLoaded = false; // Check stand textures
-    if (!bgTex || !platformTex || !attackZombieTex || !tankZombieTex || !foodTex || !texturesLoaded) {
+    if (!levelLoaded) {
+        std::cerr << "Critical level data missing: run make levels to bake " << levelPath << ".\n";
+    }
+    if (!bgTex || !platformTex || !archetypesLoaded || !foodTex || !texturesLoaded || !levelLoaded) {
         std::cerr << "Critical texture missing. Ensure all PNGs are in assets/ folder. Check console logs for details.\n";
         std::cerr << "Texture status: background=" << (bgTex ? "loaded" : "null") << ", platform=" << (platformTex ? "loaded" : "null")
-                  << ", attackZombie=" << (attackZombieTex ? "loaded" : "null") << ", tankZombie=" << (tankZombieTex ? "loaded" : "null")
+                  << ", zombies=" << (archetypesLoaded ? "loaded" : "null")
                   << ", food=" << (foodTex ? "loaded" : "null") << "\n"; // Log texture status
         // Cleanup resources
+        registry.destroyTextures();
         weather.cleanup();
         TTF_CloseFont(font);
         TTF_Quit();
@@ -633,17 +1345,55 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
         return 1; // Return 1 for menu exit
     }
     
-    // Define platforms for the game terrain
-    std::vector<Platform> platforms = {
-        {0, 17, 30, 2, platformTex}, // Ground level
-        {2, 12, 8, 1, platformTex}, // Platform 1
-        {15, 12, 8, 1, platformTex}, // Platform 2
-        {10, 8, 5, 1, platformTex}, // Platform 3
-        {2, 4, 8, 1, platformTex}, // Platform 4
-        {15, 4, 8, 1, platformTex} // Platform 5
-    };
+    // Collision straight from the baked tables: nothing is computed at startup
+    Terrain terrain = level.isLoaded() ? Terrain(level)
+        : Terrain(DEFAULT_PLATFORMS, DEFAULT_PLATFORM_RECTS, DEFAULT_SOLID_BITS.data(), DEFAULT_COLS, DEFAULT_ROWS, TILE_SIZE);
+    if (!level.isLoaded()) {
+        for (const auto& path : DEFAULT_MOVERS) terrain.addMover(path); // Elevators and moving ledges
+        terrain.setIndestructibleFrom(DEFAULT_GROUND_ROW); // Keep a floor under everyone
+    }
+
+    // Terrain image, drawn once and then only repainted where tiles break
+    TerrainCache terrainCache;
+    terrainCache.init(ren, terrain.getCols() * TILE_SIZE, terrain.getRows() * TILE_SIZE, [&](SDL_Renderer* r, const SDL_Rect& region) {
+        int c0 = region.x / TILE_SIZE, c1 = std::min(terrain.getCols(), (region.x + region.w + TILE_SIZE - 1) / TILE_SIZE);
+        int r0 = region.y / TILE_SIZE, r1 = std::min(terrain.getRows(), (region.y + region.h + TILE_SIZE - 1) / TILE_SIZE);
+        int layers = level.isLoaded() ? level.getLayerCount() : 1;
+        for (int layer = 0; layer < layers; ++layer) {
+            for (int y = r0; y < r1; ++y) {
+                for (int x = c0; x < c1; ++x) {
+                    // Layer 0 is the collision layer, so destroyed tiles are gone from it
+                    uint8_t tile = level.isLoaded() ? level.tileAt(layer, x, y) : 1;
+                    if (layer == 0 && !terrain.solidTile(x, y)) tile = 0;
+                    if (tile == 0 || tile >= TILESET_SIZE) continue; // Empty or no texture for this ID
+                    SDL_Rect dst = {x * TILE_SIZE, y * TILE_SIZE, TILE_SIZE, TILE_SIZE};
+                    SDL_RenderCopy(r, tileset[tile], nullptr, &dst); // Render tile
+                }
+            }
+        }
+    });
+
+    // Spawn surfaces come baked with the level; they only need rebuilding if an archetype outgrew the baked box
+    const double TICK_BUDGET = 0.008; // Simulation time per tick that spawning may fill up to
+    SpawnScheduler spawner(TICK_BUDGET);
+    std::span<const SpawnSurface> bakedSurfaces = level.isLoaded() ? level.getSpawnSurfaces() : std::span<const SpawnSurface>(DEFAULT_SPAWN_SURFACES);
+    int bakedWidth = level.isLoaded() ? level.getSpawnWidth() : DEFAULT_SPAWN_BOX;
+    int bakedHeight = level.isLoaded() ? level.getSpawnHeight() : DEFAULT_SPAWN_BOX;
+    if (registry.maxWidth() <= bakedWidth && registry.maxHeight() <= bakedHeight) {
+        spawner.load(bakedSurfaces.data(), bakedSurfaces.size(), bakedHeight);
+    } else {
+        std::cerr << "Zombies in zombies.cfg are larger than the level's baked spawn box; raise it and rebuild\n";
+        spawner.build(terrain.rects, registry.maxWidth(), registry.maxHeight(), DEFAULT_SPAWN_BOUNDS);
+    }
 
-    Terrain terrain(platforms); // Initialize terrain with platforms
+    // Jump landing tables for the AI: one speed class per archetype walking speed, one force class per tree jump check
+    std::vector<float> jumpSpeeds;
+    for (int id = 0; id < registry.count(); id++) {
+        if (std::find(jumpSpeeds.begin(), jumpSpeeds.end(), registry.speed[id]) == jumpSpeeds.end()) jumpSpeeds.push_back(registry.speed[id]);
+    }
+    JumpTable jumps;
+    jumps.build(terrain, jumpSpeeds, brains.jumpForces(), GRAVITY);
+    brains.setJumpTable(&jumps);
 
     // Initialize player
     PhysicsEntity player(TILE_SIZE * 3.0f, TILE_SIZE * 10.0f - 48.0f, 48, 48, runTextures, standTextures);
@@ -652,20 +1402,36 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
     // Initialize game variables
     int score = 0; // Current score
     double startTime = SDL_GetTicks() / 1000.0; // Game start time
-    std::vector<Zombie*> zombies; // List of active zombies
-    std::vector<Food*> foods; // List of active food items
+    ZombieHorde horde; // Active zombies, grouped by archetype
+    FrameArena frameArena(64 * 1024); // Scratch memory for one frame, reset after it is presented
+    horde.groups.resize(registry.count());
+    std::mt19937 rng(std::random_device{}()); // Random generator for drop rolls
+    std::vector<Food> foods; // List of active food items
     bool attacking = false; // Whether player is attacking
     double lastAttackTime = 0.0; // Time of last attack
     const double ATTACK_COOLDOWN = 0.5; // Attack cooldown time
     const int MELEE_DAMAGE = 25; // Damage dealt by player attack
     const int MELEE_RANGE = 100; // Range of player attack
     const int MAX_ZOMBIES_ONSCREEN = 5; // Maximum zombies on screen
-    const int ZOMBIES_PER_WAVE[] = {10, 10, 10, 10, 1}; // Zombies per wave
-    // const int ZOMBIES_PER_WAVE[] = {0, 0, 0, 0, 1}; // Zombies per wave
     const int TOTAL_WAVES = 5; // Total number of waves
-    int wave = 1; // Current wave
-    int zombiesToSpawn = ZOMBIES_PER_WAVE[0]; // Zombies left to spawn
-    int waveZombiesRemaining = 0; // Zombies remaining in current wave
+    WaveDirector director(TOTAL_WAVES); // Runs the wave scripts
+    int bossArchetype = std::max(0, registry.find("tank")); // Archetype spawned for boss waves
+    horde.reserve(MAX_ZOMBIES_ONSCREEN + 1); // Spawning stays off the heap during play (the boss may come on top)
+    brains.reserve((MAX_ZOMBIES_ONSCREEN + 1) * registry.count());
+    foods.reserve(64);
+    terrain.prepareEdits();
+    const int ALLOC_WARMUP_TICKS = 300; // Gameplay ticks before allocations count as steady-state violations
+    int playTicks = 0; // Gameplay ticks so far
+    uint64_t frameNumber = 0; // Frames presented so far
+    std::ofstream allocLog; // Per-frame allocation counts, when tracking is compiled in
+    if (allocTrackingEnabled()) {
+        allocLog.open("alloc_log.csv");
+        allocLogHeader(allocLog);
+    }
+    bool restoredWaves = false; // Whether the director was resumed from a save
+    perfReset(); // Frame phase counters cover this game only
+    traceStart(); // Record frames for spike dumps (off with --spike-ms=0)
+    metricsStartGame(); // Time in the menus is not a frame
 
     // Load saved game state if requested
     if (loadSaved) {
@@ -679,17 +1445,19 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
             for (const auto& zombie : state.zombies) {
                 float x = std::get<0>(zombie);
                 float y = std::get<1>(zombie);
-                Zombie::Type type = std::get<2>(zombie);
-                SDL_Texture* tex = (type == Zombie::ATTACK) ? attackZombieTex : tankZombieTex;
-                zombies.push_back(new Zombie(x, y, 32, 32, tex, type)); // Restore zombies
+                int type = std::get<2>(zombie);
+                if (type < 0 || type >= registry.count()) continue; // Archetype no longer exists
+                addZombie(horde, registry, brains, x, y, type); // Restore zombies
             }
-            wave = state.wave; // Restore wave
-            zombiesToSpawn = state.zombiesToSpawn; // Restore zombies to spawn
-            waveZombiesRemaining = state.waveZombiesRemaining; // Restore remaining zombies
+            WaveResumeState resume = {state.wave, state.waveStep, state.zombiesToSpawn, state.pendingBosses, state.waveWaitRemaining};
+            director.restore(resume, SDL_GetTicks() / 1000.0); // Resume the wave script where it was saved
+            restoredWaves = true;
             weather.setType(state.weatherType); // Restore weather state
         }
     }
 
+    if (!restoredWaves) director.start(SDL_GetTicks() / 1000.0); // Start wave 1
+
     int highScore = loadHighScore("highscore.dat"); // Load high score
 
     // Define game screen states
@@ -715,13 +1483,12 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
     // Check for missing UI textures
     if (!pauseText || !resumeText || !saveText || !menuText || !nameText || !gameOverText || !victoryText || !backText) {
         std::cerr << "Failed to create pause menu, name, game over, or victory textures.\n"; // Log error
-        for (auto zombie : zombies) delete zombie; // Cleanup zombies
-        for (auto food : foods) delete food; // Cleanup food
         // Cleanup resources
         weather.cleanup();
+        terrainCache.cleanup();
         TTF_CloseFont(font); 
         SDL_DestroyTexture(bgTex); SDL_DestroyTexture(platformTex); SDL_DestroyTexture(playerTex);
-        SDL_DestroyTexture(attackZombieTex); SDL_DestroyTexture(tankZombieTex); SDL_DestroyTexture(foodTex);
+        registry.destroyTextures(); SDL_DestroyTexture(foodTex);
         SDL_DestroyTexture(pauseText); SDL_DestroyTexture(resumeText); SDL_DestroyTexture(saveText);
         SDL_DestroyTexture(menuText); SDL_DestroyTexture(nameText); SDL_DestroyTexture(gameOverText);
         SDL_DestroyTexture(victoryText); SDL_DestroyTexture(backText);
@@ -738,16 +1505,61 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
     enum ButtonState { NORMAL, HOVERED, PRESSED };
     ButtonState resumeState = NORMAL, saveState = NORMAL, menuState = NORMAL, backState = NORMAL;
 
+    // Memory breakdown (F2): what each part of the game holds, refreshed once a second while shown
+    const int MEMORY_REFRESH_FRAMES = 60; // Frames between overlay refreshes
+    bool showMemory = false; // Whether the memory overlay is shown
+    int memoryAge = 0; // Frames since the overlay was refreshed
+    MemoryReport memoryReport; // Last collected breakdown
+    std::error_code fontError;
+    size_t fontBytes = std::filesystem::file_size("arial.ttf", fontError); // The open font is estimated at its file size
+    if (fontError) fontBytes = 0;
+    auto reportMemory = [&](MemoryReport& report) {
+        report.clear();
+        reportSimulationMemory(report, horde, brains, terrain, jumps);
+        report.add(MEM_ENTITIES, "food", vectorBytes(foods), foods.size());
+        report.add(MEM_ENTITIES, "player", sizeof(player));
+        report.add(MEM_TERRAIN, "mapped level file", level.getFileSize());
+        report.add(MEM_BUFFERS, "frame arena", frameArena.getCapacity());
+        report.add(MEM_FONTS, "arial.ttf (24 pt)", fontBytes);
+        report.addTexture("terrain cache", terrainCache.getTexture());
+        report.addTexture("day.png (weather)", weather.getDayTexture());
+        report.addTexture("night.png (weather)", weather.getNightTexture());
+        report.addTexture("day.png", bgTex);
+        report.addTexture("tile_wall.png", platformTex);
+        report.addTexture("player.png", playerTex);
+        report.addTexture("food.png", foodTex);
+        for (int i = 0; i < 10; i++) report.addTexture("player_run" + std::to_string(i + 1) + ".png", runTextures[i]);
+        for (int i = 0; i < 12; i++) report.addTexture("player_stand" + std::to_string(i + 1) + ".png", standTextures[i]);
+        for (int id = 0; id < registry.count(); id++) report.addTexture(registry.spritePaths[id], registry.textures[id]);
+        size_t textBytes = 0;
+        for (SDL_Texture* text : {pauseText, resumeText, saveText, menuText, nameText, gameOverText, victoryText, backText}) textBytes += textureBytes(text);
+        report.add(MEM_TEXTURES, "UI text", textBytes, 8);
+    };
+
+    int metricsMemoryAge = MEMORY_REFRESH_FRAMES; // Frames since the memory gauges were refreshed (--metrics-socket)
+
     // Main game loop
     while (running) {
+        bool ticked = false; // Whether this frame runs a simulation tick
         // Handle events
         while (SDL_PollEvent(&e)) {
             if (e.type == SDL_QUIT) {
                 running = false; // Exit on window close
             } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE && gameState == PLAYING) {
                 gameState = PAUSED; // Pause game
+                traceEvent("pause");
             } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE && gameState == PAUSED) {
                 gameState = PLAYING; // Resume game
+                traceEvent("resume");
+            } else if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F2) {
+                showMemory = !showMemory; // Toggle the memory overlay, printing the full breakdown when it opens
+                if (showMemory) {
+                    AllocExempt exempt;
+                    reportMemory(memoryReport);
+                    memoryReport.print(std::cout);
+                    memoryAge = 0;
+                    traceEvent("memory report");
+                }
             } else if (gameState == PLAYING) {
                 if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_SPACE && player.onGround && !jumping) {
                     player.accelerate(0, JUMP_FORCE); // Player jumps
@@ -778,6 +1590,7 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
                     if (resumeState == PRESSED) {
                         gameState = PLAYING; // Resume game
                         resumeState = NORMAL;
+                        traceEvent("resume");
                     } else if (saveState == PRESSED) {
                         GameState state;
                         state.playerPos = player.pos;
@@ -786,15 +1599,24 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
                         state.score = score;
                         state.startTime = (SDL_GetTicks() / 1000.0) - startTime;
                         state.isValid = true;
-                        for (const auto& zombie : zombies) {
-                            state.zombies.emplace_back(zombie->pos.x, zombie->pos.y, zombie->type); // Save zombies
+                        for (const auto& group : horde.groups) {
+                            for (const auto& zombie : group) {
+                                state.zombies.emplace_back(zombie.pos.x, zombie.pos.y, zombie.archetype); // Save zombies
+                            }
                         }
-                        state.wave = wave;
-                        state.zombiesToSpawn = zombiesToSpawn;
-                        state.waveZombiesRemaining = waveZombiesRemaining;
+                        WaveResumeState resume = director.save(SDL_GetTicks() / 1000.0);
+                        state.wave = resume.wave;
+                        state.zombiesToSpawn = resume.pendingSpawns;
+                        state.waveZombiesRemaining = static_cast<int>(horde.size());
+                        state.waveStep = resume.step;
+                        state.pendingBosses = resume.pendingBosses;
+                        state.waveWaitRemaining = resume.waitRemaining;
                         state.weatherType = weather.getType(); // Save weather state
+                        Uint64 saveStart = SDL_GetPerformanceCounter();
                         saveGameState(state, "savegame.dat"); // Save game state
+                        metricsRecordSave((SDL_GetPerformanceCounter() - saveStart) / static_cast<double>(SDL_GetPerformanceFrequency()));
                         saveState = NORMAL;
+                        traceEvent("save", static_cast<long long>(state.zombies.size()));
                     } else if (menuState == PRESSED) {
                         running = false; // Exit to menu
                         menuState = NORMAL;
@@ -816,6 +1638,11 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
         }
 
         if (gameState == PLAYING) {
+            ticked = true;
+            allocSetSteady(++playTicks > ALLOC_WARMUP_TICKS); // Past warm-up, every container should be at capacity
+            Uint64 tickStart = SDL_GetPerformanceCounter(); // Start of simulation work for this tick
+            double spawnSeconds = 0.0; // Time spent spawning this tick
+
             // Handle player input
             const Uint8* keys = SDL_GetKeyboardState(NULL);
             bool hasInput = false;
@@ -832,90 +1659,128 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
                 std::cout << "Moving right\n"; // Log movement
             }
 
-            player.update(&terrain, hasInput, isMovingRight, isMovingLeft); // Update player
+            {
+                AllocScope scope(ALLOC_PHYSICS);
+                PerfScope phase(PERF_COLLISION);
+                terrain.updateMovers(); // Move platforms before the bodies resting on them
+                player.update(&terrain, hasInput, isMovingRight, isMovingLeft); // Update player
+            }
             
             double currentTime = SDL_GetTicks() / 1000.0; // Current time
 
             weather.update(currentTime); // Update weather system
 
-            // Spawn zombies if needed
-            if (zombiesToSpawn > 0 && zombies.size() < MAX_ZOMBIES_ONSCREEN) {
-                spawnZombie(zombies, terrain, attackZombieTex, tankZombieTex); // Spawn a zombie
-                zombiesToSpawn--;
-                waveZombiesRemaining++;
+            {
+                AllocScope scope(ALLOC_WAVES);
+                int wave = director.getWave();
+                director.update(currentTime, static_cast<int>(horde.size())); // Resume wave scripts that are due
+                if (director.getWave() != wave) traceEvent("wave", director.getWave());
             }
 
-            SDL_Rect playerRect = player.getRect(); // Player's bounding rectangle
-            std::vector<Zombie*> zombiesToDelete; // Zombies to remove
-            for (auto& zombie : zombies) {
-                zombie->update(&terrain, player, isMovingRight, isMovingLeft); // Update zombie
-                SDL_Rect zombieRect = zombie->getRect(); // Zombie's bounding rectangle
-                if (SDL_HasIntersection(&playerRect, &zombieRect)) { // Check collision with player
-                    if (currentTime - zombie->lastDamageTime >= 1.0) {
-                        player.health -= zombie->damage; // Damage player
-                        zombie->lastDamageTime = currentTime;
-                        if (player.health < 0) player.health = 0;
-                    }
-                }
-                if (SDL_HasIntersection(&playerRect, &zombieRect)) { // Duplicate collision check (redundant)
-                    if (currentTime - zombie->lastDamageTime >= 1.0) {
-                        player.health -= zombie->damage;
-                        zombie->lastDamageTime = currentTime;
-                        if (player.health < 0) player.health = 0;
+            // Spawn zombies queued by the wave director, in a batch sized to the spare tick budget
+            int capacity = std::max(0, MAX_ZOMBIES_ONSCREEN - static_cast<int>(horde.size()));
+            int batch = spawner.allowance(director.pendingBosses + std::min(director.pendingSpawns, capacity));
+            if (batch > 0) {
+                AllocScope scope(ALLOC_SPAWN);
+                Uint64 spawnStart = SDL_GetPerformanceCounter();
+                for (int i = 0; i < batch; i++) {
+                    if (director.pendingBosses > 0) {
+                        spawnZombie(horde, spawner, terrain, registry, brains, bossArchetype); // Spawn the boss
+                        director.pendingBosses--;
+                    } else {
+                        spawnZombie(horde, spawner, terrain, registry, brains); // Spawn a zombie
+                        director.pendingSpawns--;
                     }
                 }
-                if (attacking) { // Handle player attack
-                    SDL_Rect attackRect = {static_cast<int>(player.pos.x - MELEE_RANGE / 2 + player.w / 2),
-                                        static_cast<int>(player.pos.y - MELEE_RANGE / 2 + player.h / 2),
-                                        MELEE_RANGE, MELEE_RANGE}; // Attack hitbox
-                    if (SDL_HasIntersection(&attackRect, &zombieRect)) {
-                        zombie->health -= MELEE_DAMAGE; // Damage zombie
-                        if (zombie->health <= 0) {
-                            if (foodTex) {
-                                spawnFood(foods, zombie->pos.x, zombie->pos.y, foodTex); // Spawn food on death
-                            }
-                            zombiesToDelete.push_back(zombie); // Mark for deletion
-                            score += 100; // Increase score
-                            waveZombiesRemaining--;
-                        }
-                    }
+                spawnSeconds = (SDL_GetPerformanceCounter() - spawnStart) / static_cast<double>(SDL_GetPerformanceFrequency());
+                spawner.recordSpawns(batch, spawnSeconds);
+                traceEvent("spawn", batch);
+            }
+
+            SDL_Rect playerRect = player.getRect(); // Player's bounding rectangle
+            {
+                AllocScope scope(ALLOC_AI);
+                PerfScope phase(PERF_AI);
+                bool resorted = horde.sortSpatially(); // Keep neighbours close in memory for the passes below
+                if (resorted) traceEvent("resort", static_cast<long long>(horde.size()));
+                for (int id = 0; id < registry.count(); id++) {
+                    // Regroup with the new order before sensing, so a follower promoted to leader senses this tick
+                    if (resorted) formZombieSquads(horde.groups[id], brains, frameArena);
+                    senseZombieGroup(horde.groups[id], &terrain, brains, static_cast<float>(registry.health[id])); // Gather AI inputs
                 }
+                brains.evaluate(player.pos.x, player.pos.y, currentTime); // Run behavior trees in batches
             }
-            // Remove dead zombies
-            for (auto zombie : zombiesToDelete) {
-                auto it = std::find(zombies.begin(), zombies.end(), zombie);
-                if (it != zombies.end()) {
-                    delete *it;
-                    zombies.erase(it);
+
+            ZombieTick tick;
+            tick.terrain = &terrain;
+            tick.horde = &horde;
+            tick.brains = &brains;
+            tick.player = &player;
+            tick.playerRect = playerRect;
+            tick.attacking = attacking;
+            tick.attackRect = {static_cast<int>(player.pos.x - MELEE_RANGE / 2 + player.w / 2),
+                               static_cast<int>(player.pos.y - MELEE_RANGE / 2 + player.h / 2),
+                               MELEE_RANGE, MELEE_RANGE}; // Attack hitbox
+            tick.meleeDamage = MELEE_DAMAGE;
+            tick.currentTime = currentTime;
+            tick.registry = &registry;
+            tick.rng = &rng;
+            tick.foods = &foods;
+            tick.foodTex = foodTex;
+            tick.kills = 0;
+            {
+                AllocScope scope(ALLOC_ZOMBIES);
+                PerfScope phase(PERF_ZOMBIES);
+                for (int id = 0; id < registry.count(); id++) {
+                    updateZombieGroup(horde.groups[id], id, tick); // One loop per archetype group
                 }
             }
+            score += 100 * tick.kills; // Increase score
+            if (tick.kills > 0) traceEvent("kills", tick.kills);
             attacking = false; // Reset attack state
 
-            // Update and check food items
-            for (auto it = foods.begin(); it != foods.end();) {
-                Food* food = *it;
-                food->update(&terrain, false); // Update food
-                if (currentTime - food->spawnTime >= Food::LIFETIME) { // Check if food expired
-                    delete food;
-                    it = foods.erase(it);
-                    continue;
+            // Refresh whatever broken tiles touched: the cached terrain image, jump landings and food resting nearby
+            SDL_Rect damaged;
+            {
+                AllocScope scope(ALLOC_TERRAIN);
+                PerfScope phase(PERF_TERRAIN);
+                while (terrain.popDirtyRegion(damaged)) {
+                    traceEvent("crater", static_cast<long long>(damaged.w) * damaged.h);
+                    terrainCache.invalidate(damaged);
+                    jumps.update(terrain, damaged); // Arcs through the crater land elsewhere now
+                    SDL_Rect around = {damaged.x - TILE_SIZE, damaged.y - TILE_SIZE, damaged.w + 2 * TILE_SIZE, damaged.h + 2 * TILE_SIZE};
+                    for (auto& food : foods) {
+                        SDL_Rect foodRect = food.getRect();
+                        if (food.sleeping && SDL_HasIntersection(&around, &foodRect)) food.wake();
+                    }
                 }
-                SDL_Rect foodRect = food->getRect(); // Food's bounding rectangle
-                if (SDL_HasIntersection(&playerRect, &foodRect)) { // Check collision with player
-                    player.health += Food::HEALTH_RESTORE; // Restore health
-                    if (player.health > 100) player.health = 100; // Cap health
-                    delete food;
-                    it = foods.erase(it); // Remove food
-                    continue;
+            }
+
+            // Update and check food items
+            {
+                AllocScope scope(ALLOC_FOOD);
+                PerfScope phase(PERF_FOOD);
+                for (auto it = foods.begin(); it != foods.end();) {
+                    it->update(&terrain); // Update food
+                    if (currentTime - it->spawnTime >= Food::LIFETIME) { // Check if food expired
+                        it = foods.erase(it);
+                        continue;
+                    }
+                    SDL_Rect foodRect = it->getRect(); // Food's bounding rectangle
+                    if (SDL_HasIntersection(&playerRect, &foodRect)) { // Check collision with player
+                        player.health += Food::HEALTH_RESTORE; // Restore health
+                        if (player.health > 100) player.health = 100; // Cap health
+                        it = foods.erase(it); // Remove food
+                        traceEvent("food eaten");
+                        continue;
+                    }
+                    ++it;
                 }
-                ++it;
             }
 
-            // Check for wave completion
-            if (waveZombiesRemaining == 0 && zombiesToSpawn == 0 && wave < TOTAL_WAVES) {
-                wave++; // Advance to next wave
-                zombiesToSpawn = ZOMBIES_PER_WAVE[wave - 1]; // Set zombies for new wave
-            } else if (waveZombiesRemaining == 0 && zombiesToSpawn == 0 && wave == TOTAL_WAVES) {
+            // Check for victory once the last wave script has finished
+            if (director.isFinished()) {
+                AllocExempt endScreen; // The victory texts are built once, on the way out
                 if (score > highScore) {
                     highScore = score;
                     saveHighScore(highScore, "highscore.dat"); // Save new high score
@@ -927,6 +1792,7 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
 
             // Check for game over conditions
             if (player.pos.y > SCREEN_HEIGHT || player.health <= 0) {
+                AllocExempt endScreen; // The game over texts are built once, on the way out
                 if (score > highScore) {
                     highScore = score;
                     saveHighScore(highScore, "highscore.dat"); // Save new high score
@@ -935,160 +1801,255 @@ int RunMainGame(const std::string& playerName, bool loadSaved, SDL_Window* win,
                 highScoreText = renderText(ren, font, "Highest Score: " + std::to_string(highScore), white); // Create high score text
                 gameState = GAME_OVER; // Set game over state
             }
+
+            double tickSeconds = (SDL_GetPerformanceCounter() - tickStart) / static_cast<double>(SDL_GetPerformanceFrequency());
+            spawner.recordTick(tickSeconds - spawnSeconds); // Feed the spawn throttle
         }
 
-        // Clear renderer
-        SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
-        SDL_RenderClear(ren);
-
-        if (gameState != GAME_OVER && gameState != VICTORY) {
-            // Render game elements
-            SDL_Rect bgRect = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
-            SDL_RenderCopy(ren, bgTex, nullptr, &bgRect); // Render background
-            weather.render(ren, SCREEN_WIDTH, SCREEN_HEIGHT); // Render weather effects
-
-            // Render platforms
-            for (const auto& p : platforms) {
-                for (int x = 0; x < p.width; ++x) {
-                    for (int y = 0; y < p.height; ++y) {
-                        SDL_Rect dst = {(p.x + x) * TILE_SIZE, (p.y + y) * TILE_SIZE, TILE_SIZE, TILE_SIZE};
-                        SDL_RenderCopy(ren, p.texture, nullptr, &dst); // Render platform tiles
+        int drawCalls = 0; // World draw calls this frame; the HUD and menus are not counted
+        {
+            // Clear renderer
+            AllocScope renderScope(ALLOC_RENDER);
+            PerfScope renderPhase(PERF_RENDER);
+            SDL_SetRenderDrawColor(ren, 0, 0, 0, 255);
+            SDL_RenderClear(ren);
+
+            if (gameState != GAME_OVER && gameState != VICTORY) {
+                // Render game elements
+                SDL_Rect bgRect = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+                SDL_RenderCopy(ren, bgTex, nullptr, &bgRect); // Render background
+                weather.render(ren, SCREEN_WIDTH, SCREEN_HEIGHT); // Render weather effects
+
+                terrainCache.render(ren); // Render terrain
+                drawCalls += 3; // Background, weather and terrain image
+                for (const auto& mover : terrain.movers) {
+                    for (int x = 0; x < mover.rect.w; x += TILE_SIZE) {
+                        SDL_Rect dst = {mover.rect.x + x, mover.rect.y, std::min(TILE_SIZE, mover.rect.w - x), mover.rect.h};
+                        SDL_RenderCopy(ren, platformTex, nullptr, &dst); // Render moving platform tiles
+                        drawCalls++;
+                    }
+                }
+                const Uint8* keys = SDL_GetKeyboardState(NULL);
+                bool isMovingRight = keys[SDL_SCANCODE_D];
+                bool isMovingLeft = keys[SDL_SCANCODE_A];
+                player.render(ren, isMovingRight, isMovingLeft); // Render player
+                drawCalls++;
+
+                for (int id = 0; id < registry.count(); id++) {
+                    renderZombieGroup(horde.groups[id], ren, registry.textures[id]); // Render zombies
+                    drawCalls += 2 * static_cast<int>(horde.groups[id].size()); // Sprite and health bar
+                }
+                for (const auto& food : foods) {
+                    food.render(ren); // Render food
+                }
+                drawCalls += static_cast<int>(foods.size());
+                if (attacking) {
+                    SDL_SetRenderDrawColor(ren, 255, 255, 0, 100); // Yellow for attack hitbox
+                    SDL_Rect attackRect = {static_cast<int>(player.pos.x - MELEE_RANGE / 2 + player.w / 2),
+                                           static_cast<int>(player.pos.y - MELEE_RANGE / 2 + player.h / 2),
+                                           MELEE_RANGE, MELEE_RANGE}; // Attack hitbox
+                    SDL_RenderFillRect(ren, &attackRect); // Render attack hitbox
+                }
+                SDL_SetRenderDrawColor(ren, 255, 0, 0, 255); // Red for health bar
+                SDL_Rect healthBar = {10, 30, player.health * 2, 20}; // Player health bar
+                SDL_RenderFillRect(ren, &healthBar); // Render health bar
+                if (nameText) {
+                    SDL_Rect nameRect = {10, 5, 0, 0};
+                    SDL_QueryTexture(nameText, nullptr, nullptr, &nameRect.w, &nameRect.h);
+                    SDL_RenderCopy(ren, nameText, nullptr, &nameRect); // Render player name
+                }
+                FrameString label("Score: ", &frameArena);
+                appendNumber(label, score);
+                SDL_Texture* scoreText = renderText(ren, font, label.c_str(), white); // Create score text
+                if (scoreText) {
+                    SDL_Rect scoreRect = {10, 60, 0, 0};
+                    SDL_QueryTexture(scoreText, nullptr, nullptr, &scoreRect.w, &scoreRect.h);
+                    SDL_RenderCopy(ren, scoreText, nullptr, &scoreRect); // Render score
+                    SDL_DestroyTexture(scoreText); // Free score text
+                }
+                label.assign("Wave: ");
+                appendNumber(label, director.getWave());
+                label.push_back('/');
+                appendNumber(label, director.getTotalWaves());
+                SDL_Texture* waveText = renderText(ren, font, label.c_str(), white); // Create wave text
+                if (waveText) {
+                    SDL_Rect waveRect = {10, 90, 0, 0};
+                    SDL_QueryTexture(waveText, nullptr, nullptr, &waveRect.w, &waveRect.h);
+                    SDL_RenderCopy(ren, waveText, nullptr, &waveRect); // Render wave
+                    SDL_DestroyTexture(waveText); // Free wave text
+                }
+                if (allocTrackingEnabled()) { // Heap use of the last frame (make tgame4-alloc)
+                    const AllocCounts& allocs = allocFrameTotal();
+                    label.assign("Allocs: ");
+                    appendNumber(label, static_cast<long long>(allocs.count));
+                    label.append(" (");
+                    appendNumber(label, static_cast<long long>(allocs.bytes));
+                    label.append(" bytes)");
+                    SDL_Texture* allocText = renderText(ren, font, label.c_str(), white);
+                    if (allocText) {
+                        SDL_Rect allocRect = {10, 120, 0, 0};
+                        SDL_QueryTexture(allocText, nullptr, nullptr, &allocRect.w, &allocRect.h);
+                        SDL_RenderCopy(ren, allocText, nullptr, &allocRect); // Render allocation counts
+                        SDL_DestroyTexture(allocText);
+                    }
+                }
+                if (showMemory) { // Memory per category, right-aligned column
+                    if (++memoryAge >= MEMORY_REFRESH_FRAMES) {
+                        AllocExempt exempt; // Debug overlay: item names are rebuilt once a second
+                        reportMemory(memoryReport);
+                        memoryAge = 0;
+                        traceEvent("memory report");
+                    }
+                    for (int tag = 0; tag <= MEM_TAG_COUNT; tag++) {
+                        if (tag < MEM_TAG_COUNT) {
+                            label.assign(memoryTagName(static_cast<MemoryTag>(tag)));
+                            label.append(": ");
+                            appendNumber(label, static_cast<long long>(memoryReport.total(static_cast<MemoryTag>(tag)) / 1024));
+                            label.append(" KB");
+                        } else {
+                            label.assign("RSS: ");
+                            appendNumber(label, static_cast<long long>(currentRssBytes() / 1024));
+                            label.append(" KB");
+                        }
+                        SDL_Texture* memoryText = renderText(ren, font, label.c_str(), white);
+                        if (!memoryText) continue;
+                        SDL_Rect memoryRect = {0, 10 + tag * 26, 0, 0};
+                        SDL_QueryTexture(memoryText, nullptr, nullptr, &memoryRect.w, &memoryRect.h);
+                        memoryRect.x = SCREEN_WIDTH - 10 - memoryRect.w;
+                        SDL_RenderCopy(ren, memoryText, nullptr, &memoryRect); // Render one category
+                        SDL_DestroyTexture(memoryText);
                     }
                 }
             }
-            const Uint8* keys = SDL_GetKeyboardState(NULL);
-            bool isMovingRight = keys[SDL_SCANCODE_D];
-            bool isMovingLeft = keys[SDL_SCANCODE_A];
-            player.render(ren, isMovingRight, isMovingLeft); // Render player
 
-            for (const auto& zombie : zombies) {
-                zombie->render(ren, zombie->vel.x > 0, zombie->vel.x < 0); // Render zombies
-            }
-            for (const auto& food : foods) {
-                food->render(ren, false, false); // Render food
-            }
-            if (attacking) {
-                SDL_SetRenderDrawColor(ren, 255, 255, 0, 100); // Yellow for attack hitbox
-                SDL_Rect attackRect = {static_cast<int>(player.pos.x - MELEE_RANGE / 2 + player.w / 2),
-                                       static_cast<int>(player.pos.y - MELEE_RANGE / 2 + player.h / 2),
-                                       MELEE_RANGE, MELEE_RANGE}; // Attack hitbox
-                SDL_RenderFillRect(ren, &attackRect); // Render attack hitbox
-            }
-            SDL_SetRenderDrawColor(ren, 255, 0, 0, 255); // Red for health bar
-            SDL_Rect healthBar = {10, 30, player.health * 2, 20}; // Player health bar
-            SDL_RenderFillRect(ren, &healthBar); // Render health bar
-            if (nameText) {
-                SDL_Rect nameRect = {10, 5, 0, 0};
-                SDL_QueryTexture(nameText, nullptr, nullptr, &nameRect.w, &nameRect.h);
-                SDL_RenderCopy(ren, nameText, nullptr, &nameRect); // Render player name
-            }
-            SDL_Texture* scoreText = renderText(ren, font, "Score: " + std::to_string(score), white); // Create score text
-            if (scoreText) {
-                SDL_Rect scoreRect = {10, 60, 0, 0};
-                SDL_QueryTexture(scoreText, nullptr, nullptr, &scoreRect.w, &scoreRect.h);
-                SDL_RenderCopy(ren, scoreText, nullptr, &scoreRect); // Render score
-                SDL_DestroyTexture(scoreText); // Free score text
-            }
-            SDL_Texture* waveText = renderText(ren, font, "Wave: " + std::to_string(wave) + "/5", white); // Create wave text
-            if (waveText) {
-                SDL_Rect waveRect = {10, 90, 0, 0};
-                SDL_QueryTexture(waveText, nullptr, nullptr, &waveRect.w, &waveRect.h);
-                SDL_RenderCopy(ren, waveText, nullptr, &waveRect); // Render wave
-                SDL_DestroyTexture(waveText); // Free wave text
-            }
-        }
+            if (gameState == PAUSED) {
+                // Render pause menu
+                SDL_SetRenderDrawColor(ren, 0, 0, 0, 200); // Semi-transparent overlay
+                SDL_Rect pauseOverlay = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+                SDL_RenderFillRect(ren, &pauseOverlay);
+
+                SDL_Rect pauseTextRect = {300, 100, 200, 50};
+                SDL_RenderCopy(ren, pauseText, nullptr, &pauseTextRect); // Render "Paused" text
+
+                // Render resume button
+                Uint8 resumeColor = (resumeState == HOVERED) ? 220 : (resumeState == PRESSED ? 180 : 200);
+                roundedBoxRGBA(ren, resumeRect.x, resumeRect.y, resumeRect.x + resumeRect.w, resumeRect.y + resumeRect.h, 10, resumeColor, resumeColor, resumeColor, 255);
+                SDL_RenderCopy(ren, resumeText, nullptr, &resumeRect);
+
+                // Render save button
+                Uint8 saveColor = (saveState == HOVERED) ? 220 : (saveState == PRESSED ? 180 : 200);
+                roundedBoxRGBA(ren, saveRect.x, saveRect.y, saveRect.x + saveRect.w, saveRect.y + saveRect.h, 10, saveColor, saveColor, saveColor, 255);
+                SDL_RenderCopy(ren, saveText, nullptr, &saveRect);
+
+                // Render menu button
+                Uint8 menuColor = (menuState == HOVERED) ? 220 : (menuState == PRESSED ? 180 : 200);
+                roundedBoxRGBA(ren, menuRect.x, menuRect.y, menuRect.x + menuRect.w, menuRect.y + menuRect.h, 10, menuColor, menuColor, menuColor, 255);
+                SDL_RenderCopy(ren, menuText, nullptr, &menuRect);
+            } else if (gameState == GAME_OVER) {
+                // Render game over screen
+                SDL_SetRenderDrawColor(ren, 0, 0, 0, 200); // Semi-transparent overlay
+                SDL_Rect gameOverOverlay = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+                SDL_RenderFillRect(ren, &gameOverOverlay);
+
+                SDL_Rect gameOverTextRect = {300, 100, 200, 50};
+                SDL_RenderCopy(ren, gameOverText, nullptr, &gameOverTextRect); // Render "Game Over!" text
+
+                if (scoreTextGameOver) {
+                    SDL_Rect scoreTextRect = {300, 180, 0, 0};
+                    SDL_QueryTexture(scoreTextGameOver, nullptr, nullptr, &scoreTextRect.w, &scoreTextRect.h);
+                    SDL_RenderCopy(ren, scoreTextGameOver, nullptr, &scoreTextRect); // Render score
+                }
 
-        if (gameState == PAUSED) {
-            // Render pause menu
-            SDL_SetRenderDrawColor(ren, 0, 0, 0, 200); // Semi-transparent overlay
-            SDL_Rect pauseOverlay = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
-            SDL_RenderFillRect(ren, &pauseOverlay);
-
-            SDL_Rect pauseTextRect = {300, 100, 200, 50};
-            SDL_RenderCopy(ren, pauseText, nullptr, &pauseTextRect); // Render "Paused" text
-
-            // Render resume button
-            Uint8 resumeColor = (resumeState == HOVERED) ? 220 : (resumeState == PRESSED ? 180 : 200);
-            roundedBoxRGBA(ren, resumeRect.x, resumeRect.y, resumeRect.x + resumeRect.w, resumeRect.y + resumeRect.h, 10, resumeColor, resumeColor, resumeColor, 255);
-            SDL_RenderCopy(ren, resumeText, nullptr, &resumeRect);
-
-            // Render save button
-            Uint8 saveColor = (saveState == HOVERED) ? 220 : (saveState == PRESSED ? 180 : 200);
-            roundedBoxRGBA(ren, saveRect.x, saveRect.y, saveRect.x + saveRect.w, saveRect.y + saveRect.h, 10, saveColor, saveColor, saveColor, 255);
-            SDL_RenderCopy(ren, saveText, nullptr, &saveRect);
-
-            // Render menu button
-            Uint8 menuColor = (menuState == HOVERED) ? 220 : (menuState == PRESSED ? 180 : 200);
-            roundedBoxRGBA(ren, menuRect.x, menuRect.y, menuRect.x + menuRect.w, menuRect.y + menuRect.h, 10, menuColor, menuColor, menuColor, 255);
-            SDL_RenderCopy(ren, menuText, nullptr, &menuRect);
-        } else if (gameState == GAME_OVER) {
-            // Render game over screen
-            SDL_SetRenderDrawColor(ren, 0, 0, 0, 200); // Semi-transparent overlay
-            SDL_Rect gameOverOverlay = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
-            SDL_RenderFillRect(ren, &gameOverOverlay);
-
-            SDL_Rect gameOverTextRect = {300, 100, 200, 50};
-            SDL_RenderCopy(ren, gameOverText, nullptr, &gameOverTextRect); // Render "Game Over!" text
-
-            if (scoreTextGameOver) {
-                SDL_Rect scoreTextRect = {300, 180, 0, 0};
-                SDL_QueryTexture(scoreTextGameOver, nullptr, nullptr, &scoreTextRect.w, &scoreTextRect.h);
-                SDL_RenderCopy(ren, scoreTextGameOver, nullptr, &scoreTextRect); // Render score
-            }
+                if (highScoreText) {
+                    SDL_Rect highScoreTextRect = {300, 260, 0, 0};
+                    SDL_QueryTexture(highScoreText, nullptr, nullptr, &highScoreTextRect.w, &highScoreTextRect.h);
+                    SDL_RenderCopy(ren, highScoreText, nullptr, &highScoreTextRect); // Render high score
+                }
 
-            if (highScoreText) {
-                SDL_Rect highScoreTextRect = {300, 260, 0, 0};
-                SDL_QueryTexture(highScoreText, nullptr, nullptr, &highScoreTextRect.w, &highScoreTextRect.h);
-                SDL_RenderCopy(ren, highScoreText, nullptr, &highScoreTextRect); // Render high score
-            }
+                // Render back button
+                Uint8 backColor = (backState == HOVERED) ? 220 : (backState == PRESSED ? 180 : 200);
+                roundedBoxRGBA(ren, backRect.x, backRect.y, backRect.x + backRect.w, backRect.y + backRect.h, 10, backColor, backColor, backColor, 255);
+                SDL_RenderCopy(ren, backText, nullptr, &backRect);
+            } else if (gameState == VICTORY) {
+                // Render victory screen
+                SDL_SetRenderDrawColor(ren, 0, 0, 0, 200); // Semi-transparent overlay
+                SDL_Rect victoryOverlay = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+                SDL_RenderFillRect(ren, &victoryOverlay);
+
+                SDL_Rect victoryTextRect = {300, 100, 200, 50};
+                SDL_RenderCopy(ren, victoryText, nullptr, &victoryTextRect); // Render "Victory!" text
+
+                if (scoreTextGameOver) {
+                    SDL_Rect scoreTextRect = {300, 180, 0, 0};
+                    SDL_QueryTexture(scoreTextGameOver, nullptr, nullptr, &scoreTextRect.w, &scoreTextRect.h);
+                    SDL_RenderCopy(ren, scoreTextGameOver, nullptr, &scoreTextRect); // Render score
+                }
 
-            // Render back button
-            Uint8 backColor = (backState == HOVERED) ? 220 : (backState == PRESSED ? 180 : 200);
-            roundedBoxRGBA(ren, backRect.x, backRect.y, backRect.x + backRect.w, backRect.y + backRect.h, 10, backColor, backColor, backColor, 255);
-            SDL_RenderCopy(ren, backText, nullptr, &backRect);
-        } else if (gameState == VICTORY) {
-            // Render victory screen
-            SDL_SetRenderDrawColor(ren, 0, 0, 0, 200); // Semi-transparent overlay
-            SDL_Rect victoryOverlay = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
-            SDL_RenderFillRect(ren, &victoryOverlay);
-
-            SDL_Rect victoryTextRect = {300, 100, 200, 50};
-            SDL_RenderCopy(ren, victoryText, nullptr, &victoryTextRect); // Render "Victory!" text
-
-            if (scoreTextGameOver) {
-                SDL_Rect scoreTextRect = {300, 180, 0, 0};
-                SDL_QueryTexture(scoreTextGameOver, nullptr, nullptr, &scoreTextRect.w, &scoreTextRect.h);
-                SDL_RenderCopy(ren, scoreTextGameOver, nullptr, &scoreTextRect); // Render score
-            }
+                if (highScoreText) {
+                    SDL_Rect highScoreTextRect = {300, 260, 0, 0};
+                    SDL_QueryTexture(highScoreText, nullptr, nullptr, &highScoreTextRect.w, &highScoreTextRect.h);
+                    SDL_RenderCopy(ren, highScoreText, nullptr, &highScoreTextRect); // Render high score
+                }
 
-            if (highScoreText) {
-                SDL_Rect highScoreTextRect = {300, 260, 0, 0};
-                SDL_QueryTexture(highScoreText, nullptr, nullptr, &highScoreTextRect.w, &highScoreTextRect.h);
-                SDL_RenderCopy(ren, highScoreText, nullptr, &highScoreTextRect); // Render high score
+                // Render back button
+                Uint8 backColor = (backState == HOVERED) ? 220 : (backState == PRESSED ? 180 : 200);
+                roundedBoxRGBA(ren, backRect.x, backRect.y, backRect.x + backRect.w, backRect.y + backRect.h, 10, backColor, backColor, backColor, 255);
+                SDL_RenderCopy(ren, backText, nullptr, &backRect);
             }
 
-            // Render back button
-            Uint8 backColor = (backState == HOVERED) ? 220 : (backState == PRESSED ? 180 : 200);
-            roundedBoxRGBA(ren, backRect.x, backRect.y, backRect.x + backRect.w, backRect.y + backRect.h, 10, backColor, backColor, backColor, 255);
-            SDL_RenderCopy(ren, backText, nullptr, &backRect);
+            PerfScope presentPhase(PERF_PRESENT); // Present and frame pacing, to the end of the block
+            SDL_RenderPresent(ren); // Present rendered frame
+            frameArena.reset(); // Drop this frame's scratch data
+            allocEndFrame();
+            if (allocLog.is_open()) allocLogFrame(allocLog, frameNumber);
+            frameNumber++;
+            if (allocStrict() && allocViolation()) { // Test mode: steady-state gameplay must not touch the heap
+                allocReportViolation(std::cerr);
+                running = false;
+            }
+            SDL_Delay(16); // Cap frame rate to ~60 FPS
         }
-
-        SDL_RenderPresent(ren); // Present rendered frame
-        SDL_Delay(16); // Cap frame rate to ~60 FPS
+        {
+            PerfScope publishPhase(PERF_PUBLISH); // Reporting after the frame is on screen, charged to the frame it reports
+            if (metricsRunning()) {
+                if (++metricsMemoryAge >= MEMORY_REFRESH_FRAMES) { // Memory gauges once a second, like the overlay
+                    AllocExempt exempt;
+                    reportMemory(memoryReport);
+                    metricsMemoryAge = 0;
+                }
+                metricsEndFrame({ticked, static_cast<int>(horde.size()), static_cast<int>(foods.size()), director.getWave(),
+                                 director.pendingSpawns, drawCalls, memoryReport.total(MEM_TEXTURES), memoryReport.total()});
+            }
+            if (SharedFrame* shared = sharedStateBeginWrite()) { // Live state for external tools
+                static_assert(static_cast<int>(VICTORY) == SHARED_VICTORY, "Game screens are published as they are numbered");
+                shared->frame = frameNumber;
+                shared->time = SDL_GetTicks() / 1000.0 - startTime;
+                shared->screen = gameState;
+                shared->score = score;
+                shared->wave = director.getWave();
+                shared->pendingSpawns = director.pendingSpawns;
+                publishSharedState(*shared, player, horde, foods);
+                sharedStateEndWrite();
+            }
+        }
+        perfEndFrame(); // After the delay and the publishing, so the frame time covers the whole frame
+        traceEndFrame({static_cast<int>(horde.size()), static_cast<int>(foods.size()), director.getWave(), director.pendingSpawns});
+    }
+    traceStop(); // Write a spike window cut short by the end of the game
+    if (SharedFrame* shared = sharedStateBeginWrite()) {
+        shared->screen = SHARED_MENU; // Back to the menu; the last frame's entities stay for inspection
+        sharedStateEndWrite();
     }
+    if (perfEnabled()) perfReport(std::cout); // Counters per frame phase (--perf-counters)
 
     // Cleanup resources
-    for (auto zombie : zombies) delete zombie;
-    zombies.clear();
-    for (auto food : foods) delete food;
-    foods.clear();
     weather.cleanup(); // Clean up weather system
+    terrainCache.cleanup(); // Free cached terrain image
     TTF_CloseFont(font);
     SDL_DestroyTexture(bgTex);
     SDL_DestroyTexture(platformTex);
     SDL_DestroyTexture(playerTex);
-    SDL_DestroyTexture(attackZombieTex);
-    SDL_DestroyTexture(tankZombieTex);
+    registry.destroyTextures();
     SDL_DestroyTexture(foodTex);
     SDL_DestroyTexture(pauseText);
     SDL_DestroyTexture(resumeText);